@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+//-------------------------------------------------------------
+// Heap allocations made through operator new since the start
+// of the program, on all threads.  allocation_counter.cpp
+// replaces the global operator new and delete to count them,
+// so it is linked into the parser binary only.  Take the
+// difference of two counts around the code of interest.
+//-------------------------------------------------------------
+
+struct AllocationCount {
+  std::size_t allocations;
+  std::size_t bytes;
+};
+
+AllocationCount allocation_count( void );
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "token.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<Token> token_vector;
+
+//-------------------------------------------------------------
+// The kinds of node the parser builds.  Each node refers to
+// one token, noted next to the kind, and has the children
+// listed.  Children in [] are optional.
+//-------------------------------------------------------------
+
+enum class NodeKind : std::uint32_t {
+  program,             // none;             data_declaration* function*
+  data_declaration,    // type name;        variable+
+  variable,            // ID;               [array size expression]
+  function,            // ID;               parameter_list [block]
+  parameter_list,      // left_parenthesis; parameter*
+  parameter,           // ID
+  block,               // left_brace;       data_declaration* statement*
+  assignment,          // ID;               identifier or index, expression
+  if_statement,        // if;               condition block
+  while_statement,     // while;            condition block
+  return_statement,    // return;           [expression]
+  break_statement,     // break
+  continue_statement,  // continue
+  read_statement,      // ID
+  write_statement,     // write;            expression
+  print_statement,     // STRING
+  condition,           // && or || or none; comparison [comparison]
+  comparison,          // comparison op;    expression expression
+  binary,              // + - * /;          expression expression
+  number,              // NUMBER
+  negative_number,     // NUMBER
+  identifier,          // ID
+  index,               // ID;               expression
+  call                 // ID;               expression*
+};
+
+//-------------------------------------------------------------
+// A node is a fixed 16 bytes.  Links are 32-bit indexes into
+// the node array, not pointers.  Index 0 is the program node,
+// which is never anyone's child or sibling, so 0 doubles as
+// the null link.
+//-------------------------------------------------------------
+
+struct AstNode {
+  NodeKind      kind;
+  std::uint32_t token;
+  std::uint32_t first_child;
+  std::uint32_t next_sibling;
+};
+
+class Ast {
+
+ public:
+
+  static const std::uint32_t null_node = 0;
+  static const std::uint32_t no_token = 0xffffffff;
+
+  Ast();
+  virtual ~Ast();
+
+  Ast( const Ast & src ) = delete;
+  Ast( const Ast && src ) = delete;
+
+  const Ast & operator=( const Ast & other ) = delete;
+  const Ast & operator=( const Ast && other ) = delete;
+
+  //-----------------------------------------------------------
+  // Bump-allocate a node with no links and return its index.
+  //-----------------------------------------------------------
+
+  std::uint32_t add_node( NodeKind kind, std::uint32_t token ) {
+    nodes.push_back( AstNode{ kind, token, null_node, null_node } );
+    return( static_cast<std::uint32_t>( nodes.size()-1 ) );
+  }
+
+  AstNode & operator[]( std::uint32_t index ) { return( nodes[index] ); }
+  const AstNode & operator[]( std::uint32_t index ) const { return( nodes[index] ); }
+
+  std::uint32_t size(void) const { return( static_cast<std::uint32_t>( nodes.size() ) ); }
+  const AstNode * data(void) const { return( nodes.data() ); }
+
+  //-----------------------------------------------------------
+  // Drop the whole tree at once.  Nodes are trivially
+  // destructible, so this only resets the allocation point;
+  // the storage is kept for the next tree.
+  //-----------------------------------------------------------
+
+  void clear(void) { nodes.clear(); }
+
+  std::size_t get_memory_size(void) const { return( nodes.capacity() * sizeof( AstNode ) ); }
+
+  //-----------------------------------------------------------
+  // Print the tree, one node per line and indented by depth,
+  // with the text of each node's token taken from 'tokens'.
+  //-----------------------------------------------------------
+
+  void print( std::ostream & out, const token_vector & tokens ) const;
+
+  //-----------------------------------------------------------
+  // The walk behind print(), for any array of nodes laid out
+  // like ours.  token_text( out, token ) prints a token.
+  //-----------------------------------------------------------
+
+  template< typename TokenText >
+  static void print_nodes( std::ostream & out, const AstNode * nodes, std::uint32_t count,
+			   TokenText token_text );
+
+  static const char * get_kind_display( NodeKind kind );
+
+ protected:
+ private:
+
+  std::vector<AstNode> nodes;
+
+};
+
+//-------------------------------------------------------------
+// Walk the tree depth first.  An explicit stack is used so
+// that printing a deeply nested tree does not depend on the
+// machine stack any more than parsing it did.
+//-------------------------------------------------------------
+
+template< typename TokenText >
+void Ast::print_nodes( std::ostream & out, const AstNode * nodes, std::uint32_t count,
+		       TokenText token_text ) {
+
+  if( count == 0 ) {
+    return;
+  }
+
+  std::vector<std::pair<std::uint32_t,unsigned>> pending{ { 0, 0 } };
+
+  while( !pending.empty() ) {
+
+    std::uint32_t index = pending.back().first;
+    unsigned depth = pending.back().second;
+    pending.pop_back();
+
+    const AstNode & node = nodes[index];
+
+    out << std::string( 2*depth, ' ' ) << get_kind_display( node.kind );
+
+    if( node.token != no_token ) {
+      token_text( out, node.token );
+    }
+
+    out << std::endl;
+
+    //------------------------------------------------------------
+    // Push the children last to first so the first comes off the
+    // stack next.
+    //------------------------------------------------------------
+
+    std::size_t first = pending.size();
+
+    for( std::uint32_t child = node.first_child; child != null_node; child = nodes[child].next_sibling ) {
+      pending.emplace_back( child, depth+1 );
+    }
+
+    std::reverse( pending.begin()+first, pending.end() );
+
+  }
+
+}
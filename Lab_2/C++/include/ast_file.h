@@ -0,0 +1,104 @@
+#pragma once
+
+#include "ast.h"
+#include "token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+//-------------------------------------------------------------
+// Binary tree files.  A file holds, back to back:
+//
+//   AstFileHeader
+//   AstNode       [node_count]    exactly as in Ast
+//   AstFileToken  [token_count]   the scanner's whole table
+//   char          [pool_size]     token text, each distinct
+//                                 text stored once
+//
+// Nothing in the file is a pointer.  Nodes refer to tokens
+// and to each other by index, tokens to their text by offset
+// into the pool, so the file is used in place once mapped.
+// Integers are in the byte order of the writer;  byte_order
+// tells a reader whether that is its own.
+//-------------------------------------------------------------
+
+struct AstFileHeader {
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t node_count;
+  std::uint32_t token_count;
+  std::uint32_t pool_size;
+  std::uint32_t reserved;
+};
+
+struct AstFileToken {
+  std::uint32_t type;          // a TokenType
+  std::uint32_t line_number;
+  std::uint32_t name;          // offset into the pool
+  std::uint32_t length;
+};
+
+//-------------------------------------------------------------
+// Write 'tree', whose tokens are 'tokens', to 'filename' in
+// one pass.  On failure the reason is in 'error_message'.
+//-------------------------------------------------------------
+
+bool write_ast_file( const std::string & filename,
+		     const Ast & tree,
+		     const token_vector & tokens,
+		     std::string & error_message );
+
+//-------------------------------------------------------------
+// A tree file mapped into memory.  open() checks the header
+// and the section sizes against the file, which costs the
+// same for any size of tree.  validate() also checks every
+// link and text range, for files from an untrusted source.
+//-------------------------------------------------------------
+
+class AstFile {
+
+ public:
+
+  static const std::uint32_t version = 1;
+
+  AstFile();
+  virtual ~AstFile();
+
+  AstFile( const AstFile & src ) = delete;
+  AstFile( const AstFile && src ) = delete;
+
+  const AstFile & operator=( const AstFile & other ) = delete;
+  const AstFile & operator=( const AstFile && other ) = delete;
+
+  bool open( const std::string & filename, std::string & error_message );
+  void close( void );
+  bool validate( std::string & error_message ) const;
+
+  std::uint32_t size(void) const { return( header ? header->node_count : 0 ); }
+  const AstNode & operator[]( std::uint32_t index ) const { return( nodes[index] ); }
+
+  std::uint32_t get_token_count(void) const { return( header ? header->token_count : 0 ); }
+  const AstFileToken & get_token( std::uint32_t index ) const { return( tokens[index] ); }
+  const char * get_token_text( std::uint32_t index ) const { return( pool + tokens[index].name ); }
+
+  //-----------------------------------------------------------
+  // Print the tree the same way Ast::print() does.
+  //-----------------------------------------------------------
+
+  void print( std::ostream & out ) const;
+
+ protected:
+ private:
+
+  void          *mapping;
+  std::size_t    mapping_size;
+
+  const AstFileHeader *header;
+  const AstNode       *nodes;
+  const AstFileToken  *tokens;
+  const char          *pool;
+
+};
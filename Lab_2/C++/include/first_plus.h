@@ -7,6 +7,8 @@
 
 //-------------------------------------------------------------
 // The first plus table enumerated for all first plus checks.
+// The productions of nonterminals the parser merges, see
+// parser.h, go by those of the one they are merged into.
 //-------------------------------------------------------------
 
 enum class FirstPlus {
@@ -39,8 +41,6 @@ enum class FirstPlus {
   parameter_list_p3,
   func_1_p0,
   func_1_p1,
-  func_4_p0,
-  func_4_p1,
   func_list_p0,
   factor_p0,
   factor_p1,
@@ -50,8 +50,6 @@ enum class FirstPlus {
   term_0_p1,
   expression_0_p0,
   expression_0_p1,
-  func_list_0_p0,
-  func_list_0_p1,
   parameter_list_0_p0,
   parameter_list_0_p1,
   non_empty_list_0_p0,
@@ -59,9 +57,6 @@ enum class FirstPlus {
   func_2_p0,
   func_2_p1,
   func_2_p2,
-  func_5_p0,
-  func_5_p1,
-  func_5_p2,
   func_p0,
   factor_0_p0,
   factor_0_p1,
@@ -75,8 +70,6 @@ enum class FirstPlus {
   func_3_p0,
   func_3_p1,
   statements_p0,
-  func_6_p0,
-  func_6_p1,
   factor_1_p0,
   factor_1_p1,
   id_list_p0,
@@ -107,8 +100,6 @@ enum class FirstPlus {
   condition_p0,
   condition_expression_0_p0,
   condition_expression_0_p1,
-  block_statements_0_p0,
-  block_statements_0_p1,
   non_empty_expr_list_0_p0,
   non_empty_expr_list_0_p1,
   comparison_op_p0,
@@ -128,17 +119,16 @@ enum class FirstPlus {
 typedef std::map<FirstPlus,std::vector<Token>> FIRST_PLUS_SET;
 
 //-------------------------------------------------------------
-// Establish the first plus sets.  This should be called
-// only one time across all Parse objects.  The Parse class
-// enforces this rule.
+// The first plus sets, indexed by FirstPlus.  They are built
+// on first use, safely from any thread, and are read only.
 //-------------------------------------------------------------
 
-void initialize_first_plus_sets( void );
+const std::vector<std::vector<Token>> & first_plus_table( void );
 
 //-------------------------------------------------------------
 // Compare a parse token and see if it's in the first plus set.
 // Use the enumeration to identify the correct first plus table.
 //-------------------------------------------------------------
 
-bool check_first_plus_set( Token & token, FirstPlus name );
+bool check_first_plus_set( const Token & token, FirstPlus name );
 
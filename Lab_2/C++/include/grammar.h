@@ -0,0 +1,206 @@
+#pragma once
+
+#include "token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------------------
+// An LL(1) grammar, loaded at run time from a file written
+// like grammarLL1.txt:
+//
+//   <program>   --> <type_name> ID <program_0>   [FIRST_PLUS = ...]
+//                 | EPSILON                      [FIRST_PLUS = ...]
+//
+// A rule is a nonterminal in angle brackets followed by -->,
+// its other productions each on a line of their own starting
+// with |.  Anything in square brackets is left out, and so is
+// every other line.  The first rule defines the start symbol.
+//
+// Every other symbol is a terminal, matched against tokens as
+// follows.  ID, NUMBER and STRING match tokens of that type,
+// eof the end of file token.  The symbol names of the grammar
+// file, such as semicolon or left_brace, match their symbols,
+// and any other name matches the reserved word or symbol
+// spelled that way, such as int or <=.
+//
+// The FIRST+ sets in the file are not read.  load() merges
+// equivalent nonterminals, see merge_equivalent(), computes
+// the predict table from the productions, and fails if the
+// grammar is not LL(1).
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+// A rule as written:  the nonterminal, angle brackets and
+// all, and its productions, each a list of symbol names, the
+// empty list for EPSILON.  read_grammar_rules() reads them
+// from the text of a grammar file, in order, the productions
+// of a nonterminal with more than one rule under the first.
+//-------------------------------------------------------------
+
+struct GrammarRule {
+  std::string                           name;
+  std::vector<std::vector<std::string>> productions;
+};
+
+typedef std::vector<GrammarRule> rule_vector;
+
+bool read_grammar_rules( const std::string & filename,
+			 const std::string & text,
+			 rule_vector & rules,
+			 std::string & error_message );
+
+class Grammar {
+
+ public:
+
+  static const std::uint32_t no_symbol = 0xffffffff;
+  static const std::uint32_t no_production = 0xffffffff;
+
+  Grammar();
+  virtual ~Grammar();
+
+  Grammar( const Grammar & src ) = delete;
+  Grammar( const Grammar && src ) = delete;
+
+  const Grammar & operator=( const Grammar & other ) = delete;
+  const Grammar & operator=( const Grammar && other ) = delete;
+
+  //-----------------------------------------------------------
+  // Load the grammar in 'filename'.  The tables are cached in
+  // the file of the same name with ".tables" appended, and
+  // read from there instead when they were computed from the
+  // very same grammar text.  A cache that cannot be written is
+  // no error;  the tables are then computed on every load.
+  //-----------------------------------------------------------
+
+  bool load( const std::string & filename, std::string & error_message );
+  bool loaded_from_cache(void) const { return( from_cache ); }
+
+  //-----------------------------------------------------------
+  // Build from rules instead, the first being the start.  It
+  // fails if a nonterminal has no rule.  Unlike load(), it
+  // builds a grammar that is not LL(1) all the same, the first
+  // production contending for a cell taking it, and lists
+  // each contended cell in get_conflicts(), and each
+  // nonterminal that derives no string of terminals.
+  //-----------------------------------------------------------
+
+  bool build( const rule_vector & rules, std::string & error_message );
+  const std::vector<std::string> & get_conflicts(void) const { return( conflicts ); }
+
+  //-----------------------------------------------------------
+  // Write the grammar in the format load() reads, each
+  // production with its FIRST+ set.  Tables read from a cache
+  // come without the sets, and are written without them.
+  //-----------------------------------------------------------
+
+  void write( std::ostream & out ) const;
+
+  //-----------------------------------------------------------
+  // The bytes held by the names, productions, tables and
+  // lookup of terminals, see memory_report.h.
+  //-----------------------------------------------------------
+
+  std::size_t get_memory_size(void) const;
+
+  //-----------------------------------------------------------
+  // Symbols are numbered terminals first, then nonterminals.
+  //-----------------------------------------------------------
+
+  std::uint32_t get_terminal_count(void) const    { return( terminal_count ); }
+  std::uint32_t get_nonterminal_count(void) const { return( static_cast<std::uint32_t>( names.size() ) - terminal_count ); }
+  std::uint32_t get_start(void) const             { return( start ); }
+  std::uint32_t get_production_count(void) const  { return( static_cast<std::uint32_t>( lhs.size() ) ); }
+  bool is_terminal( std::uint32_t symbol ) const  { return( symbol < terminal_count ); }
+  const std::string & get_name( std::uint32_t symbol ) const { return( names[symbol] ); }
+
+  //-----------------------------------------------------------
+  // The production to expand 'nonterminal' by with 'terminal'
+  // next, or no_production.  'terminal' may be no_symbol.
+  //-----------------------------------------------------------
+
+  std::uint32_t predict( std::uint32_t nonterminal, std::uint32_t terminal ) const {
+    return( (terminal < terminal_count) ? table[(nonterminal - terminal_count) * terminal_count + terminal] : no_production );
+  }
+
+  //-----------------------------------------------------------
+  // The nonterminal 'production' expands, and its right hand
+  // side, empty for EPSILON.  The productions of a nonterminal
+  // are numbered one after the other.
+  //-----------------------------------------------------------
+
+  std::uint32_t get_lhs( std::uint32_t production ) const { return( lhs[production] ); }
+
+  const std::uint32_t * begin_of( std::uint32_t production ) const { return( rhs.data() + offsets[production] ); }
+  const std::uint32_t * end_of( std::uint32_t production ) const   { return( rhs.data() + offsets[production + 1] ); }
+
+  //-----------------------------------------------------------
+  // How 'terminal' is written in a program, empty for ID,
+  // NUMBER, STRING and eof, which are not spelled one way.
+  //-----------------------------------------------------------
+
+  std::string get_spelling( std::uint32_t terminal ) const;
+
+  //-----------------------------------------------------------
+  // The terminal 'token' matches, or no_symbol.
+  //-----------------------------------------------------------
+
+  std::uint32_t terminal_of( const Token & token ) const {
+    std::uint32_t terminal = type_terminals[static_cast<std::size_t>( token.get_token_type() )];
+    if( terminal == text_terminal ) {
+      auto named = text_terminals.find( token.get_token_name() );
+      terminal = (named != text_terminals.end()) ? named->second : no_symbol;
+    }
+    return( terminal );
+  }
+
+ protected:
+ private:
+
+  //-----------------------------------------------------------
+  // Symbol names, productions and the predict table, which is
+  // what the cache holds.  Production p is lhs[p] --> the
+  // symbols of rhs from offsets[p] up to offsets[p+1].
+  //-----------------------------------------------------------
+
+  std::vector<std::string>   names;
+  std::uint32_t              terminal_count;
+  std::uint32_t              start;
+  std::vector<std::uint32_t> lhs;
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint32_t> rhs;
+  std::vector<std::uint32_t> table;
+  bool                       from_cache;
+
+  //-----------------------------------------------------------
+  // What the table was computed from:  the FIRST+ set of each
+  // production, EPSILON first when it derives EPSILON, and the
+  // contended cells.
+  //-----------------------------------------------------------
+
+  static const std::uint32_t epsilon = 0xfffffffd;
+
+  std::vector<std::vector<std::uint32_t>> first_plus;
+  std::vector<std::string>                conflicts;
+
+  //-----------------------------------------------------------
+  // From token to terminal.  Reserved words and symbols are
+  // looked up by their text, the other types directly.
+  //-----------------------------------------------------------
+
+  static const std::uint32_t text_terminal = 0xfffffffe;
+
+  std::vector<std::uint32_t>                     type_terminals;
+  std::unordered_map<std::string, std::uint32_t> text_terminals;
+
+  void compute_table( void );
+  bool read_cache( const std::string & filename, std::uint64_t hash );
+  bool write_cache( const std::string & filename, std::uint64_t hash ) const;
+  void match_terminals( void );
+
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "grammar.h"
+
+//-------------------------------------------------------------
+// Rewrites that take a grammar written the natural way toward
+// LL(1), the way grammarLL1.txt was taken there by hand.  A
+// new nonterminal is named after the one it was split from,
+// with the first free number, as in <program_0>.  It follows
+// that rule, so the rules of one construct stay together.
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+// Substitute the productions of a rule for a leading
+// nonterminal wherever that nonterminal leads back to the
+// rule, then turn
+//
+//   <A> --> <A> a | b         into   <A>   --> b <A_0>
+//                                    <A_0> --> a <A_0>
+//                                            | EPSILON
+//
+// <A> --> <A> a | EPSILON becomes <A> --> a <A> | EPSILON.
+// A leading nonterminal that derives EPSILON is not looked
+// through, so left recursion behind one is left in place and
+// shows as a conflict.  So is a rule with no other production,
+// and so is <A> --> <A>, which is kept as it is.
+//-------------------------------------------------------------
+
+void eliminate_left_recursion( rule_vector & rules );
+
+//-------------------------------------------------------------
+// Turn productions of a rule that begin alike into one, which
+// ends in a new nonterminal for what follows the longest
+// prefix they share, until no two begin with the same symbol.
+// Repeated productions are dropped.
+//-------------------------------------------------------------
+
+void left_factor( rule_vector & rules );
+
+//-------------------------------------------------------------
+// Merge nonterminals that derive alike:  those with the same
+// productions once each nonterminal in them is replaced by
+// the first of those it is merged with.  Nonterminals that
+// lead only to each other, such as <func_2> and <func_5>
+// through <func_3> and <func_6>, are merged together.  The
+// first rule of each set stays, and so does the start.
+//-------------------------------------------------------------
+
+void merge_equivalent( rule_vector & rules );
+
+//-------------------------------------------------------------
+// Drop the rules the first rule cannot reach.
+//-------------------------------------------------------------
+
+void remove_unreachable( rule_vector & rules );
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "parse_listener.h"
+#include "parser.h"
+#include "scanner.h"
+#include "token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-------------------------------------------------------------
+// Reparsing after an edit, a function at a time.  parse()
+// parses a whole input and keeps the result of each function
+// body:  its braces, a hash of its tokens and its counts.
+//
+// update() takes the scanner of the edited input, in which
+// the 'removed' tokens from index 'first' on were replaced by
+// 'inserted' new ones.  If the edit falls between the braces
+// of one body and removes or inserts no braces, only that
+// body is reparsed and the ones after it are moved along.
+// Any other edit reparses the top level.  Then only the
+// bodies whose tokens changed are reparsed.  Bodies with
+// errors are always reparsed, so that the line numbers in
+// their errors stay current.
+//
+// The counts are those of Parser, and so are the errors of a
+// Parser that parsed the bodies with finish().
+//-------------------------------------------------------------
+
+class IncrementalParser {
+
+ public:
+
+  IncrementalParser();
+  virtual ~IncrementalParser();
+
+  IncrementalParser( const IncrementalParser & src ) = delete;
+  IncrementalParser( const IncrementalParser && src ) = delete;
+
+  const IncrementalParser & operator=( const IncrementalParser & other ) = delete;
+  const IncrementalParser & operator=( const IncrementalParser && other ) = delete;
+
+  bool parse( Scanner & scanner );
+  bool update( Scanner & scanner, std::uint32_t first, std::uint32_t removed, std::uint32_t inserted );
+
+  void set_max_nesting_depth( unsigned depth ) { max_nesting_depth = depth; }
+
+  bool get_pass(void) const                        { return( pass ); }
+  CountListener & get_listener(void)               { return( totals ); }
+  const std::vector<ParseError> & get_errors(void) { return( errors ); }
+
+  //-----------------------------------------------------------
+  // How many bodies the last parse() or update() parsed.
+  //-----------------------------------------------------------
+
+  std::size_t get_reparsed_count(void) const { return( reparsed ); }
+
+ protected:
+ private:
+
+  struct Function {
+    Parser::Body            body;
+    std::uint64_t           hash;
+    bool                    pass;
+    CountListener           counts;
+    std::vector<ParseError> errors;
+  };
+
+  unsigned max_nesting_depth;
+
+  //-----------------------------------------------------------
+  // The last parse:  the top level, the bodies in input order
+  // and the index of every brace, as of 'token_count' tokens.
+  //-----------------------------------------------------------
+
+  bool                       top_level_pass;
+  CountListener              top_level;
+  std::vector<ParseError>    top_level_errors;
+  std::vector<Function>      functions;
+  std::vector<std::uint32_t> braces;
+  std::size_t                token_count;
+
+  //-----------------------------------------------------------
+  // The totals over all of the above.
+  //-----------------------------------------------------------
+
+  bool                    pass;
+  CountListener           totals;
+  std::vector<ParseError> errors;
+  std::size_t             reparsed;
+
+  void parse_function( Scanner & scanner, Function & function );
+  void total( void );
+
+  static std::uint64_t hash_body( const token_vector & tokens, const Parser::Body & body );
+
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------------------
+// The memory of the parser's structures, for '--mem-report'.
+// A structure is measured by its capacity rather than its
+// size, since that is what it holds on to, and a string by
+// what it allocated past the characters that fit in the
+// string itself.  What the allocator adds to each block is
+// not counted, so the structures add up to less than the
+// process holds; the peak resident size is for that.
+//-------------------------------------------------------------
+
+inline std::size_t string_memory( const std::string & text ) {
+  static const std::size_t in_place = std::string().capacity();
+  return( (text.capacity() > in_place) ? text.capacity() + 1 : 0 );
+}
+
+inline std::size_t string_vector_memory( const std::vector<std::string> & strings ) {
+  std::size_t bytes = strings.capacity() * sizeof( std::string );
+  for( const std::string & text : strings ) {
+    bytes += string_memory( text );
+  }
+  return( bytes );
+}
+
+inline std::size_t token_vector_memory( const std::vector<Token> & tokens ) {
+  std::size_t bytes = tokens.capacity() * sizeof( Token );
+  for( const Token & token : tokens ) {
+    bytes += string_memory( token.get_token_name() );
+  }
+  return( bytes );
+}
+
+struct MemoryItem {
+  const char  *name;
+  std::size_t bytes;
+};
+
+//-------------------------------------------------------------
+// The most memory the process has had resident, in bytes, or
+// 0 where that is not known.
+//-------------------------------------------------------------
+
+std::size_t peak_resident_size( void );
+
+//-------------------------------------------------------------
+// Each item, their total and the peak resident size, in bytes
+// and in bytes per byte of source and per token.
+//-------------------------------------------------------------
+
+void print_memory_report( std::ostream & out, const std::vector<MemoryItem> & items,
+			  std::uint64_t source_bytes, std::uint64_t tokens );
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "first_plus.h"
+#include "token.h"
+
+//-------------------------------------------------------------
+// Parse listeners.  The Parser is a template over a listener
+// class, which it calls as the parse goes:
+//
+//   begin( production )  the production, named by its entry
+//                        in the FIRST+ table, was chosen
+//   end( production )    its right hand side is matched
+//   token( word )        word was matched and is consumed
+//
+// EPSILON productions are not reported.  Lists are reported
+// the way they are parsed, as loops:  each element has its
+// own begin / end of the list production (statements_p0,
+// data_decls_p0, func_list_p0, program_1_p0, id_list_0_p0,
+// non_empty_list_0_p0, non_empty_expr_list_0_p0), and the
+// productions that only lead back into the list are left
+// out.  Expressions are not parsed by the <term> <factor>
+// cascade.  Each expression, nested ones included, is one
+// expression_p0 holding a <factor> production per operand.
+// Binary operators show up as tokens only.
+//
+// The members are called directly, never through a virtual,
+// so a listener with empty inline members costs nothing.
+// merge( other ) adds in what another listener saw;  parsing
+// on several threads gives each its own listener, see
+// BasicParser::set_threads().
+// A production whose match fails is never ended, even when
+// program_0 falls back to its other production and the parse
+// goes on to pass.
+//-------------------------------------------------------------
+
+class NullListener {
+
+ public:
+
+  void begin( FirstPlus /* production */ ) {}
+  void end( FirstPlus /* production */ )   {}
+  void token( const Token & /* word */ )   {}
+
+  void merge( const NullListener & /* other */ ) {}
+
+};
+
+//-------------------------------------------------------------
+// The counts requested in the assignment.  A function is
+// counted once its left_parenthesis is matched.  Global data
+// declarations after the first, and the first function, are
+// counted as functions as well;  that is what the counts have
+// always been.  Those declarations are credited only once the
+// whole list of them matched.
+//-------------------------------------------------------------
+
+class CountListener {
+
+ public:
+
+  CountListener() :
+    variable_count{0}, function_count{0}, statement_count{0}, declarations{0} {}
+
+  unsigned get_variable_count(void)   { return( variable_count ); }
+  unsigned get_function_count(void)   { return( function_count ); }
+  unsigned get_statement_count(void)  { return( statement_count ); }
+
+  void begin( FirstPlus production ) {
+
+    switch( production ) {
+
+    case FirstPlus::id_p0 :
+    case FirstPlus::func_or_data_p0 : { ++variable_count; break; }
+
+    case FirstPlus::func_0_p0 :
+    case FirstPlus::func_0_p1 : { ++function_count; break; }
+
+    case FirstPlus::statement_p0 :
+    case FirstPlus::statement_p1 :
+    case FirstPlus::statement_p2 :
+    case FirstPlus::statement_p3 :
+    case FirstPlus::statement_p4 :
+    case FirstPlus::statement_p5 :
+    case FirstPlus::statement_p6 :
+    case FirstPlus::statement_p7 :
+    case FirstPlus::statement_p8 : { ++statement_count; break; }
+
+    default : { break; }
+
+    }
+
+  }
+
+  void end( FirstPlus production ) {
+
+    if( production == FirstPlus::program_1_p0 ) {
+      ++declarations;
+    } else if( production == FirstPlus::program_0_p0 ) {
+      function_count += declarations;
+      declarations = 0;
+    }
+
+  }
+
+  void token( const Token & /* word */ ) {}
+
+  void merge( const CountListener & other ) {
+    variable_count  += other.variable_count;
+    function_count  += other.function_count;
+    statement_count += other.statement_count;
+    declarations    += other.declarations;
+  }
+
+ private:
+
+  unsigned variable_count;
+  unsigned function_count;
+  unsigned statement_count;
+  unsigned declarations;
+
+};
@@ -1,42 +1,127 @@
 #pragma once
 
+#include "ast.h"
 #include "first_plus.h"
+#include "parse_listener.h"
 #include "scanner.h"
 #include "token.h"
+#include "token_source.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
-static bool first_plus_sets_initialized = false;
+//-------------------------------------------------------------
+// A syntax error.  'token' is the index, in the source's
+// tokens, of the token the error was found at.
+//-------------------------------------------------------------
 
-class Parser {
+struct ParseError {
+  std::uint32_t token;
+  unsigned      line_number;
+  std::string   message;
+};
+
+//-------------------------------------------------------------
+// The parser reports what it matches to a Listener, see
+// parse_listener.h, and takes its tokens from a Source, see
+// token_source.h.  The member functions live in parser.cpp,
+// which instantiates the template for each pair in use.
+//-------------------------------------------------------------
+
+template< typename Listener, typename Source = Scanner >
+class BasicParser {
 
  public:
 
-  Parser();
-  virtual ~Parser();
+  BasicParser();
+  virtual ~BasicParser();
 
-  Parser( const Parser & src ) = delete;
-  Parser( const Parser && src ) = delete;
+  BasicParser( const BasicParser & src ) = delete;
+  BasicParser( const BasicParser && src ) = delete;
 
-  const Parser operator=( const Parser & other ) = delete;
-  const Parser operator=( const Parser && other ) = delete;
+  const BasicParser operator=( const BasicParser & other ) = delete;
+  const BasicParser operator=( const BasicParser && other ) = delete;
 
-  bool parse( Scanner & scanner );
-  unsigned get_variable_count(void)   { return( variable_count ); }
-  unsigned get_function_count(void)   { return( function_count ); }
-  unsigned get_statement_count(void)  { return( statement_count ); }
-  
- protected:
- private:
+  bool parse( const Source & source );
+  bool parse( const Source & source, Ast & tree );
+  Listener & get_listener(void) { return( listener ); }
 
   //-----------------------------------------------------------
-  // Used to control one time initialization of first+ table.
+  // The listener carries on from one parse to the next, so
+  // its counts add up.  reset() starts it over, and with it
+  // everything else, as if newly constructed.  The storage of
+  // the stacks and lists is kept for the next parse.
   //-----------------------------------------------------------
+
+  void reset( void );
+
+  //-----------------------------------------------------------
+  // Parse the top level declarations only, skipping function
+  // bodies by matching their braces.  Until finish() parses
+  // the bodies, the listener has seen each function with an
+  // empty body and a tree has an empty block for it.  finish()
+  // may run on another thread, but the parser is not to be
+  // used in the meantime.  It returns whether the whole parse
+  // passes.
+  //-----------------------------------------------------------
+
+  bool preparse( const Source & source );
+  bool preparse( const Source & source, Ast & tree );
+  bool finish( void );
+
+  //-----------------------------------------------------------
+  // A function body, by the indexes of its braces among the
+  // source's tokens.  get_skipped_bodies() lists the ones the
+  // last preparse() skipped, until finish().  parse_body()
+  // parses one on its own, adding to this parser's listener
+  // and errors.  It returns false if the body had errors.
+  //-----------------------------------------------------------
+
+  struct Body {
+    std::uint32_t first;
+    std::uint32_t last;
+  };
+
+  const std::vector<Body> & get_skipped_bodies(void) { return( deferred_bodies ); }
+  bool parse_body( const Source & source, const Body & body );
+
+  //-----------------------------------------------------------
+  // Nesting limit for blocks and nested expressions combined.
+  // Zero, the default, means no limit.  When the limit is hit
+  // the parse stops there, and the reason is the last error.
+  //-----------------------------------------------------------
+
+  void set_max_nesting_depth( unsigned depth ) { max_nesting_depth = depth; }
+
+  //-----------------------------------------------------------
+  // Parse function bodies on up to 'count' threads, one body
+  // at a time each, in parse() and finish().  One or zero, the
+  // default, parses on the calling thread only, as does
+  // parse() building a tree.  The bodies are reported to
+  // listeners of their own, merged into this parser's at the
+  // end with Listener::merge();  this one sees each function
+  // with an empty body.
+  //-----------------------------------------------------------
+
+  void set_threads( unsigned count ) { thread_count = count; }
+
+  //-----------------------------------------------------------
+  // The syntax errors of the last parse, in input order.  The
+  // parse goes on past an error.  A statement or declaration
+  // that fails is skipped up to the next semicolon, which is
+  // skipped too, right_brace, or keyword that can follow it;
+  // a top level declaration up to the next type name outside
+  // of braces.  parse() only passes if there are none.
+  //-----------------------------------------------------------
+
+  const std::vector<ParseError> & get_errors(void) { return( errors ); }
   
-  static bool first_sets_initialized;
-  
+ protected:
+ private:
+
   //-----------------------------------------------------------
   // Indicates if the parser detected a failing condition.
   //-----------------------------------------------------------
@@ -44,33 +129,144 @@ class Parser {
   bool fail_state;
 
   //-----------------------------------------------------------
-  // Holds the counts requested in the assignment.
+  // Told about every production and token matched.
   //-----------------------------------------------------------
   
-  unsigned variable_count;
-  unsigned function_count;
-  unsigned statement_count;
+  Listener listener;
 
   //-----------------------------------------------------------
-  // The scanner from projet 1, passed in as a reference.
+  // The tokens, passed in as a reference.  By default the
+  // scanner from projet 1.
   //-----------------------------------------------------------
   
-  Scanner *scanner;
+  const Source *source;
 
   //-----------------------------------------------------------
-  // It holds the current top of the token stack.
+  // The token being looked at, where it is in the source.
+  // Each parser walks the tokens with a cursor of its own, so
+  // parsers on several threads can share a source.
   //-----------------------------------------------------------
-  
-  Token current_word;
+
+  TokenCursor<Source> cursor;
+
+  //-----------------------------------------------------------
+  // Skipped function bodies, for preparse() and for parsing on
+  // several threads.  body_spans lists every pair of braces
+  // outside of any other, in input order;  the ones the top
+  // level parse skipped are left in deferred_bodies.
+  //-----------------------------------------------------------
+
+  unsigned          thread_count;
+  bool              defer_bodies;
+  bool              top_level_pass;
+  std::vector<Body> body_spans;
+  std::vector<Body> deferred_bodies;
+
+  bool parse_top_level( void );
+  bool defer_body( std::uint32_t brace );
+
+  static std::uint32_t function_name( const Source & source, std::uint32_t brace );
+
+  //-----------------------------------------------------------
+  // What has to be matched to close each open block or nested
+  // expression, innermost last.  Nesting is tracked here, on
+  // the heap, instead of by recursion on the machine stack.
+  // The blocks of if and while, and the first argument of a
+  // call and the ones after it, are told apart for the
+  // productions reported when they close.
+  //-----------------------------------------------------------
+
+  enum class Continuation { if_block, while_block, parenthesis, index, arguments, more_arguments };
+
+  std::vector<Continuation> continuations;
+  unsigned                  max_nesting_depth;
+
+  bool push_continuation( Continuation continuation );
+
+  //-----------------------------------------------------------
+  // Panic mode error recovery.  A Checkpoint holds the stack
+  // heights from before a statement or declaration, to go back
+  // to when it fails.  'stopped' is set once the parse cannot
+  // go on, 'swallowed_token' is where program_0 first gave up
+  // on a production for its other one.
+  //-----------------------------------------------------------
+
+  enum class Recovery { statement, program };
+
+  struct Checkpoint {
+    std::size_t continuations;
+    std::size_t ast_frames;
+    std::size_t ast_operands;
+    std::size_t ast_operators;
+  };
+
+  std::vector<ParseError> errors;
+  bool                    stopped;
+  std::uint32_t           swallowed_token;
+
+  Checkpoint checkpoint( void );
+  void report_error( std::uint32_t token );
+  bool recover( Recovery level, const Checkpoint & point );
+  bool declaration_follows( void );
+
+  //-----------------------------------------------------------
+  // The tree under construction, or nullptr when only
+  // validating.  ast_frames holds the open nodes, innermost
+  // last, with the operator stack height when each was opened.
+  //-----------------------------------------------------------
+
+  struct AstFrame {
+    std::uint32_t node;
+    std::uint32_t last_child;
+    std::uint32_t operators;
+  };
+
+  struct AstOperator {
+    std::uint32_t token;
+    unsigned      precedence;
+  };
+
+  Ast                       *ast;
+  std::vector<AstFrame>      ast_frames;
+  std::vector<std::uint32_t> ast_operands;
+  std::vector<AstOperator>   ast_operators;
+
+  void ast_open( NodeKind kind, std::uint32_t token );
+  void ast_open_nested( std::uint32_t node );
+  void ast_close( void );
+  void ast_leaf( NodeKind kind, std::uint32_t token );
+  void ast_append( std::uint32_t node );
+  void ast_operand( NodeKind kind, std::uint32_t token );
+  void ast_operator( unsigned precedence );
+  void ast_reduce( unsigned min_precedence );
+  std::uint32_t ast_expression_result( void );
+  void ast_close_nested( void );
+
+  //-----------------------------------------------------------
+  // Position in the source's tokens of the last type name and
+  // ID matched in a declaration or statement.  Tree nodes refer
+  // to tokens by these indexes.
+  //-----------------------------------------------------------
+
+  std::uint32_t type_token;
+  std::uint32_t name_token;
 
   //-----------------------------------------------------------
   // Convenience function for getting the next token.
+  // get_next_word() consumes the current token, telling the
+  // listener, and moves the cursor on.
   //-----------------------------------------------------------
   
   bool get_next_word( void );
+  bool parse_tokens( const Source & source, bool top_level_only );
+  void start_tree( Ast & tree );
 
   //-----------------------------------------------------------
-  // Grammar routines for LL(1) grammar.
+  // Grammar routines for LL(1) grammar.  Nonterminals that
+  // derive alike share a routine:  <func_4>, <func_5> and
+  // <func_6> are parsed as <func_1>, <func_2> and <func_3>,
+  // <block_statements_0> as <func_3> and <func_list_0> as
+  // <func_path>.
   //-----------------------------------------------------------
   
   bool program_start(void);
@@ -83,46 +279,41 @@ class Parser {
   bool func_0(void);
   bool func_path(void);
   bool expression(void);
+  unsigned binary_operator_precedence(void);
+  bool operand( bool & opened );
+  bool operand_suffix( std::uint32_t name_token, bool & opened );
+  bool close_nested_expression( bool & opened );
   bool id(void);
-  bool func_or_data(void);
+  bool func_or_data( bool & is_function );
   bool parameter_list(void);
   bool func_1(void);
-  bool func_4(void);
   bool func_list(void);
-  bool factor(void);
-  bool term_0(void);
-  bool expression_0(void);
-  bool func_list_0(void);
   bool parameter_list_0(void);
   bool non_empty_list_0(void);
   bool func_2(void);
-  bool func_5(void);
   bool func(void);
-  bool factor_0(void);
-  bool mulop(void);
-  bool addop(void);
-  bool term(void);
   bool data_decls(void);
   bool func_3(void);
   bool statements(void);
-  bool func_6(void);
-  bool factor_1(void);
   bool id_list(void);
-  bool data_decls_0(void);
   bool statement(void);
-  bool statements_0(void);
   bool expr_list(void);
   bool statement_0(void);
   bool condition_expression(void);
-  bool block_statements(void);
+  bool block_statements( FirstPlus owner );
   bool statement_2(void);
   bool non_empty_expr_list(void);
   bool statement_1(void);
   bool condition(void);
   bool condition_expression_0(void);
-  bool block_statements_0(void);
   bool non_empty_expr_list_0(void);
   bool comparison_op(void);
   bool condition_op(void);
 
 };
+
+//-------------------------------------------------------------
+// The parser main() runs, counting as it goes.
+//-------------------------------------------------------------
+
+typedef BasicParser<CountListener> Parser;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//-------------------------------------------------------------
+// Hardware and software counters of the calling thread, and of
+// the threads it starts once they have ended, by Linux's
+// perf_event_open.  Only user space is counted, which most
+// settings of perf_event_paranoid allow.
+//
+// Each counter is opened on its own, so a machine without one
+// of them, such as a virtual machine without hardware
+// counters, still has the others.  Counters the processor has
+// too few registers for are shared out in time.  A sample
+// holds what each counted and the time it was enabled and
+// counting, and difference() takes what it counted between
+// two samples around the code of interest, scaled up by the
+// time it was enabled over the time it was counting between
+// them.  Scaling the samples first could make the later one
+// the smaller.
+//-------------------------------------------------------------
+
+enum class PerfEvent { cycles, instructions, branch_misses, l1d_misses, llc_misses, page_faults };
+
+static const std::size_t perf_event_count = 6;
+
+struct PerfSample {
+  std::uint64_t values[perf_event_count];
+  std::uint64_t enabled[perf_event_count];
+  std::uint64_t running[perf_event_count];
+};
+
+class PerfCounters {
+
+ public:
+
+  PerfCounters();
+  virtual ~PerfCounters();
+
+  PerfCounters( const PerfCounters & src ) = delete;
+  PerfCounters( const PerfCounters && src ) = delete;
+
+  const PerfCounters & operator=( const PerfCounters & other ) = delete;
+  const PerfCounters & operator=( const PerfCounters && other ) = delete;
+
+  //-----------------------------------------------------------
+  // Open the counters.  It fails, with the reason, only when
+  // none of them can be opened.
+  //-----------------------------------------------------------
+
+  bool open( std::string & error_message );
+
+  bool is_available( PerfEvent event ) const { return( descriptors[static_cast<std::size_t>( event )] >= 0 ); }
+
+  PerfSample read( void ) const;
+
+  static std::uint64_t difference( const PerfSample & before, const PerfSample & after, PerfEvent event );
+
+  static const char * get_name( PerfEvent event );
+
+ protected:
+ private:
+
+  int descriptors[perf_event_count];
+
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "grammar.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------------------
+// Random programs of a Grammar, for inputs of any size.  The
+// leftmost derivation is expanded on an explicit stack, each
+// production chosen at random by its weight, and the tokens
+// written out as they are reached, so even a program of many
+// gigabytes takes no more memory than a small one.
+//
+// A symbol is one deeper than the nonterminal it came from,
+// unless it ends the production.  So a list that recurses on
+// its tail stays at the depth it started at, while each block
+// and parenthesis goes one deeper.  The deeper a nonterminal,
+// the likelier the production that ends soonest is chosen for
+// it, by the square of its depth over the maximum, and past
+// the maximum depth it always is.
+//
+// A nonterminal with no other one under it on the stack is at
+// the top level, such as the lists of declarations and
+// functions, and what it expands to starts again at depth 0.
+// There the program grows until it reaches the target size, a
+// production leading on being chosen over one that ends the
+// list, and ends once it has reached it.
+//
+// A mutated program has tokens that make it invalid:  at
+// random points a terminal the grammar cannot take there is
+// put in, in place of the next token or ahead of it.  The
+// mutations draw on random numbers of their own, so the
+// program around them is the one generated without them.
+//
+// The same grammar, options and seed give the same program
+// byte for byte.
+//-------------------------------------------------------------
+
+class ProgramGenerator {
+
+ public:
+
+  ProgramGenerator( const Grammar & grammar );
+  virtual ~ProgramGenerator();
+
+  ProgramGenerator( const ProgramGenerator & src ) = delete;
+  ProgramGenerator( const ProgramGenerator && src ) = delete;
+
+  const ProgramGenerator & operator=( const ProgramGenerator & other ) = delete;
+  const ProgramGenerator & operator=( const ProgramGenerator && other ) = delete;
+
+  void set_seed( std::uint64_t seed )              { this->seed = seed; }
+  void set_target_size( std::uint64_t size )       { target_size = size; }
+  void set_max_depth( unsigned depth )             { max_depth = depth; }
+  void set_mutation_count( unsigned count )        { mutation_count = count; }
+
+  //-----------------------------------------------------------
+  // The weights of the productions of 'nonterminal', in the
+  // order of the grammar.  All weights start at 1, and a
+  // production of weight 0 is chosen only to end soonest.
+  //-----------------------------------------------------------
+
+  bool set_weights( const std::string & nonterminal,
+		    const std::vector<unsigned> & weights,
+		    std::string & error_message );
+
+  //-----------------------------------------------------------
+  // Write a program to 'out', its size in bytes to 'size'.
+  // It fails when the start symbol derives no program at all.
+  //-----------------------------------------------------------
+
+  bool generate( std::ostream & out, std::uint64_t & size, std::string & error_message );
+
+  unsigned get_mutations_made(void) const { return( mutations_made ); }
+
+ protected:
+ private:
+
+  struct Pending {
+    std::uint32_t symbol;
+    unsigned      depth;
+  };
+
+  const Grammar &            grammar;
+  std::uint64_t              seed;
+  std::uint64_t              target_size;
+  unsigned                   max_depth;
+  unsigned                   mutation_count;
+  unsigned                   mutations_made;
+  std::uint64_t              state;
+  std::uint64_t              mutation_state;
+
+  //-----------------------------------------------------------
+  // Per nonterminal:  its first production, how many it has,
+  // and the production whose derivation is shallowest.
+  //-----------------------------------------------------------
+
+  std::vector<std::uint32_t> first_production;
+  std::vector<std::uint32_t> production_count;
+  std::vector<std::uint32_t> shortest;
+
+  //-----------------------------------------------------------
+  // Per production:  its weight, and whether it derives any
+  // program at all.
+  //-----------------------------------------------------------
+
+  std::vector<unsigned>      weights;
+  std::vector<bool>          productive;
+
+  //-----------------------------------------------------------
+  // How each terminal is written, empty for those spelled
+  // anew each time into 'token'.
+  //-----------------------------------------------------------
+
+  std::vector<std::string>   spellings;
+  std::string                token;
+
+  std::vector<Pending>       stack;
+  std::string                buffer;
+  std::uint64_t              written;
+  unsigned                   braces;
+  bool                       line_start;
+
+  static std::uint64_t random( std::uint64_t & state, std::uint64_t bound );
+
+  void analyze( void );
+  std::uint32_t choose( std::uint32_t nonterminal, unsigned depth, bool top_level );
+  const std::string & spell( std::uint32_t terminal, std::uint64_t & state );
+  void write( const std::string & text, std::ostream & out );
+  bool mutate( std::ostream & out );
+
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//-------------------------------------------------------------
+// A profile of the parser by grammar routine, built in with
+// 'make PROFILE=1' after a 'make clean'.  Otherwise
+// PROFILE_RULE and PROFILE_TOKEN are empty, and nothing of
+// this is in the binary.
+//
+// Each routine of Parser is one Rule.  For each, the profile
+// counts its calls, its cycles inclusive of the routines it
+// calls and exclusive of them, and the tokens it matched
+// itself.  A routine that recurses counts its inclusive
+// cycles once, for the outermost call.  The cycles are those
+// of the time stamp counter where there is one, nanoseconds
+// elsewhere.
+//
+// Every thread counts on its own, and adds its counts to the
+// profile when it ends.  At exit the profile is written to
+// standard error, the routines with the most exclusive cycles
+// first.
+//-------------------------------------------------------------
+
+enum class Rule {
+  program_start,
+  program,
+  type_name,
+  program_0,
+  id_0,
+  id_list_0,
+  program_1,
+  func_0,
+  func_path,
+  expression,
+  operand,
+  operand_suffix,
+  close_nested_expression,
+  id,
+  func_or_data,
+  parameter_list,
+  func_1,
+  func_list,
+  parameter_list_0,
+  non_empty_list_0,
+  func_2,
+  func,
+  data_decls,
+  func_3,
+  statements,
+  id_list,
+  statement,
+  expr_list,
+  statement_0,
+  condition_expression,
+  block_statements,
+  statement_2,
+  non_empty_expr_list,
+  statement_1,
+  condition,
+  condition_expression_0,
+  non_empty_expr_list_0,
+  comparison_op,
+  condition_op
+};
+
+static const std::size_t rule_count = 39;
+
+#ifdef PROFILE_RULES
+
+class RuleScope {
+
+ public:
+
+  RuleScope( Rule rule );
+  virtual ~RuleScope();
+
+  RuleScope( const RuleScope & src ) = delete;
+  RuleScope( const RuleScope && src ) = delete;
+
+  const RuleScope & operator=( const RuleScope & other ) = delete;
+  const RuleScope & operator=( const RuleScope && other ) = delete;
+
+ protected:
+ private:
+
+  friend void rule_profile_token( void );
+
+  Rule          rule;
+  RuleScope     *caller;
+  bool          outermost;
+  std::uint64_t callees;
+  std::uint64_t start;
+
+};
+
+void rule_profile_token( void );
+
+#define PROFILE_RULE( rule ) RuleScope rule_scope( Rule::rule )
+#define PROFILE_TOKEN()      rule_profile_token()
+
+#else
+
+#define PROFILE_RULE( rule )
+#define PROFILE_TOKEN()
+
+#endif
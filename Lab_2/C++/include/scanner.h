@@ -2,6 +2,8 @@
 
 #include "token.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <vector>
@@ -23,13 +25,39 @@ class Scanner {
   const Scanner & operator=(const Scanner & source) = delete;
   const Scanner & operator=(const Scanner && source) = delete;
 
+  //---------------------------------------------------------------------------
+  // Start over on 'text', as if newly constructed.  The storage for the text
+  // and tokens is kept, down to the text buffer of each token, so scanning the
+  // same input again allocates nothing and file after file reallocates little.
+  //---------------------------------------------------------------------------
+
+  void reset( const string_vector & text );
+
   bool has_more_tokens(void);
   const Token get_next_token(void);
   bool tokenize( std::string & error_message );
 
+  unsigned get_token_index(void) { return( token_index ); }
+  const token_vector & get_tokens(void) { return( tokens ); }
+
+  //---------------------------------------------------------------------------
+  // The tokens as a parser's token source, see token_source.h.
+  //---------------------------------------------------------------------------
+
+  std::uint32_t get_token_count(void) const { return( static_cast<std::uint32_t>( tokens.size() ) ); }
+  const Token & get_token( std::uint32_t index ) const { return( tokens[index] ); }
+
+  //---------------------------------------------------------------------------
+  // The bytes held by the scanner's copy of the text, and by its tokens, the
+  // spares included, see memory_report.h.
+  //---------------------------------------------------------------------------
+
+  std::size_t get_text_memory_size(void) const;
+  std::size_t get_token_memory_size(void) const;
+
 #ifdef DEBUG
   
-  void debug_display_token(const Token & token);
+  static void debug_display_token(const Token & token);
 
 #endif
   
@@ -40,6 +68,16 @@ class Scanner {
   token_vector  tokens;
   unsigned      token_index;
 
+  //---------------------------------------------------------------------------
+  // The tokens of the scan before reset(), whose text buffers are moved into
+  // the new tokens in turn, the first 'spare_used' of them so far.
+  //---------------------------------------------------------------------------
+
+  token_vector  spare_tokens;
+  std::size_t   spare_used;
+
+  void add_token( TokenType type, const std::string & line, unsigned start, unsigned length, unsigned line_number );
+
   void consume_whitespace( const std::string & line, unsigned & pos );
 
   bool is_whitespace( char c );
@@ -49,7 +87,7 @@ class Scanner {
 		  unsigned & stop,
 		  bool & legal_string );
   bool is_reserved_word_or_identifier( const std::string & text, unsigned start, unsigned & stop );
-  bool is_reserved_word( const std::string & text );
+  bool is_reserved_word( const std::string & text, unsigned start, unsigned length );
   bool is_letter( char c );
   bool is_digit( char c );
   bool is_symbol( const std::string & text, unsigned & start, unsigned & stop );
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "grammar.h"
+#include "parser.h"
+#include "scanner.h"
+#include "token.h"
+#include "token_source.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-------------------------------------------------------------
+// A table driven LL(1) parser for any Grammar.  Productions
+// are expanded on an explicit stack, by the grammar's predict
+// table, and terminals matched against the source's tokens.
+// The parse stops at the first error.  It passes when the
+// stack empties with the input used up, the end of file token
+// included or next.
+//
+// The member functions live in table_parser.cpp, which
+// instantiates the template for each token source in use.
+//-------------------------------------------------------------
+
+template< typename Source = Scanner >
+class TableParser {
+
+ public:
+
+  TableParser( const Grammar & grammar );
+  virtual ~TableParser();
+
+  TableParser( const TableParser & src ) = delete;
+  TableParser( const TableParser && src ) = delete;
+
+  const TableParser & operator=( const TableParser & other ) = delete;
+  const TableParser & operator=( const TableParser && other ) = delete;
+
+  bool parse( const Source & source );
+
+  //-----------------------------------------------------------
+  // The error the last parse stopped at, if any, worded as
+  // the hand written parser words its errors.
+  //-----------------------------------------------------------
+
+  const std::vector<ParseError> & get_errors(void) { return( errors ); }
+
+  //-----------------------------------------------------------
+  // How many productions the last parse expanded.
+  //-----------------------------------------------------------
+
+  std::size_t get_expansion_count(void) const { return( expansions ); }
+
+ protected:
+ private:
+
+  const Grammar &            grammar;
+  TokenCursor<Source>        cursor;
+  std::vector<std::uint32_t> stack;
+  std::vector<ParseError>    errors;
+  std::size_t                expansions;
+
+  bool fail( const Source & source, std::uint32_t token );
+
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 enum class TokenType
@@ -17,14 +18,21 @@ public:
   virtual ~Token();
 
   Token( const Token & token );
-  Token( Token && token );
+  Token( Token && token ) noexcept;
 
   const Token & operator=( const Token & token );
-  const Token & operator=( Token && token );
+  const Token & operator=( Token && token ) noexcept;
 
-  TokenType get_token_type( void );
-  const std::string & get_token_name( void );
-  unsigned get_line_number( void );
+  //---------------------------------------------------------------------------
+  // Make this the token of 'length' characters of 'text' from 'start' on.
+  // The text goes into the buffer this token already has when it fits.
+  //---------------------------------------------------------------------------
+
+  void assign( TokenType type, const std::string & text, std::size_t start, std::size_t length, unsigned line_number );
+
+  TokenType get_token_type( void ) const;
+  const std::string & get_token_name( void ) const;
+  unsigned get_line_number( void ) const;
 
 #ifdef DEBUG
 
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "token.h"
+
+#include <cstdint>
+#include <vector>
+
+//-------------------------------------------------------------
+// Where a parser takes its tokens from.  BasicParser is a
+// template over its source as well as its listener, so the
+// fetch of each token is inlined into the parse.  A source is
+// any class with
+//
+//   std::uint32_t get_token_count( void ) const;
+//   const Token & get_token( std::uint32_t index ) const;
+//
+// the tokens of the whole input, ending with EOF_TOK, each at
+// a fixed index for as long as the parse and its tree are in
+// use.  Errors, trees and skipped function bodies refer to
+// tokens by these indexes, and the parser looks back as well
+// as ahead, so a source holds every token at once.  Meta
+// statements are left out, the parser has no use for them.
+// The line number of EOF_TOK is that of the last token or
+// meta statement.  Scanner is a source, once it has
+// tokenized;  TokenTable is another.
+//-------------------------------------------------------------
+
+//-------------------------------------------------------------
+// Tokens that are already in memory, wherever they came from,
+// such as a cache of an earlier scan.  The table does not own
+// them and they must outlive it.
+//-------------------------------------------------------------
+
+class TokenTable {
+
+ public:
+
+  TokenTable( const Token *tokens, std::uint32_t count ) : tokens{tokens}, count{count} {}
+  TokenTable( const std::vector<Token> & tokens ) :
+    tokens{tokens.data()}, count{static_cast<std::uint32_t>( tokens.size() )} {}
+
+  std::uint32_t get_token_count(void) const { return( count ); }
+  const Token & get_token( std::uint32_t index ) const { return( tokens[index] ); }
+
+ protected:
+ private:
+
+  const Token   *tokens;
+  std::uint32_t  count;
+
+};
+
+//-------------------------------------------------------------
+// A parser's position among the tokens of a source.  current()
+// is the token there, in the source's own storage, and peek(k)
+// the one 'k' tokens on, or the last one past the end.  seek()
+// and advance() fail, staying put, past the last token.  Only
+// use current() and peek() once a seek() has succeeded.
+//-------------------------------------------------------------
+
+template< typename Source >
+class TokenCursor {
+
+ public:
+
+  TokenCursor() : source{nullptr}, token{nullptr}, index{0}, count{0} {}
+
+  void start( const Source & source ) {
+    this->source = &source;
+    token = nullptr;
+    index = 0;
+    count = source.get_token_count();
+  }
+
+  bool seek( std::uint32_t position ) {
+    if( position >= count ) {
+      return(false);
+    }
+    index = position;
+    token = &source->get_token( index );
+    return(true);
+  }
+
+  bool advance(void) { return( seek( index + 1 ) ); }
+
+  const Token & current(void) const { return( *token ); }
+  std::uint32_t position(void) const { return( index ); }
+
+  const Token & peek( std::uint32_t k ) const {
+    return( source->get_token( (k < count - index) ? index + k : count - 1 ) );
+  }
+
+ protected:
+ private:
+
+  const Source  *source;
+  const Token   *token;
+  std::uint32_t  index;
+  std::uint32_t  count;
+
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//-------------------------------------------------------------
+// A timeline of a run, written as Chrome trace events for
+// Perfetto or chrome://tracing to show, one track per thread.
+//
+// Each thread records into a ring buffer of its own, so that
+// recording takes no lock and allocates nothing once the
+// buffer is there.  A full buffer overwrites its oldest
+// events.  Until trace_start() is called, a span or instant
+// costs one check of a flag.
+//
+// The buffers outlive their threads.  trace_write() reads all
+// of them, so the threads that record must have been joined
+// or be idle by then.
+//-------------------------------------------------------------
+
+void trace_start( std::size_t capacity );
+bool trace_enabled( void );
+bool trace_write( const std::string & filename, std::string & error_message );
+
+//-------------------------------------------------------------
+// A moment of note, such as a cache hit.  'detail', at most
+// the first 31 bytes of it, is shown with 'name'.
+//-------------------------------------------------------------
+
+void trace_instant( const char *name, const std::string & detail );
+
+//-------------------------------------------------------------
+// A span from its construction to its destruction.  One with
+// a detail, such as the name of a function, is shown by that
+// name, under 'name' as its category, with its line.  Both
+// are kept as they are until the span ends, so 'name' must be
+// a literal and 'detail' must outlive the span.
+//-------------------------------------------------------------
+
+class TraceSpan {
+
+ public:
+
+  TraceSpan( const char *name );
+  TraceSpan( const char *name, const std::string & detail, unsigned line );
+  virtual ~TraceSpan();
+
+  TraceSpan( const TraceSpan & src ) = delete;
+  TraceSpan( const TraceSpan && src ) = delete;
+
+  const TraceSpan & operator=( const TraceSpan & other ) = delete;
+  const TraceSpan & operator=( const TraceSpan && other ) = delete;
+
+ protected:
+ private:
+
+  const char        *name;
+  const std::string *detail;
+  unsigned          line;
+  std::int64_t      start;
+
+};
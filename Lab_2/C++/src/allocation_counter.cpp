@@ -0,0 +1,90 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+//-----------------------------------------------------------------------------
+// The counts are relaxed atomics.  They are only read as totals, once the
+// threads that allocate have been joined, so no ordering is needed.
+//-----------------------------------------------------------------------------
+
+static std::atomic<std::size_t> allocations{0};
+static std::atomic<std::size_t> allocated_bytes{0};
+
+AllocationCount allocation_count( void ) {
+
+  return( AllocationCount{ allocations.load( std::memory_order_relaxed ),
+			   allocated_bytes.load( std::memory_order_relaxed ) } );
+
+}
+
+static void * counted_allocation( std::size_t size ) {
+
+  allocations.fetch_add( 1, std::memory_order_relaxed );
+  allocated_bytes.fetch_add( size, std::memory_order_relaxed );
+
+  return( std::malloc( (size == 0) ? 1 : size ) );
+
+}
+
+//-----------------------------------------------------------------------------
+// The replacements.  The nothrow and array forms are the standard library's
+// own in terms of these, but are replaced too to count the same way whichever
+// library the binary is linked with.
+//-----------------------------------------------------------------------------
+
+void * operator new( std::size_t size ) {
+
+  void *memory = counted_allocation( size );
+
+  if( memory == nullptr ) {
+    throw std::bad_alloc();
+  }
+
+  return( memory );
+
+}
+
+void * operator new[]( std::size_t size ) {
+
+  return( operator new( size ) );
+
+}
+
+void * operator new( std::size_t size, const std::nothrow_t & ) noexcept {
+
+  return( counted_allocation( size ) );
+
+}
+
+void * operator new[]( std::size_t size, const std::nothrow_t & ) noexcept {
+
+  return( counted_allocation( size ) );
+
+}
+
+void operator delete( void *memory ) noexcept {
+
+  std::free( memory );
+
+}
+
+void operator delete[]( void *memory ) noexcept {
+
+  std::free( memory );
+
+}
+
+void operator delete( void *memory, const std::nothrow_t & ) noexcept {
+
+  std::free( memory );
+
+}
+
+void operator delete[]( void *memory, const std::nothrow_t & ) noexcept {
+
+  std::free( memory );
+
+}
@@ -0,0 +1,63 @@
+#include "ast.h"
+#include "token.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// The tree lives in a single array of fixed size nodes.  The parser appends
+// nodes as it matches productions and links them by index, so the array can
+// grow (and move) freely while the tree is built, and freeing the tree is one
+// deallocation no matter how many nodes it has.
+//-----------------------------------------------------------------------------
+
+Ast::Ast() : nodes{} {
+}
+
+Ast::~Ast() {
+}
+
+void Ast::print( std::ostream & out, const token_vector & tokens ) const {
+
+  print_nodes( out, nodes.data(), size(), [&tokens]( std::ostream & out, std::uint32_t token ) {
+      if( token < tokens.size() ) {
+	out << " " << tokens[token].get_token_name();
+      }
+    } );
+
+}
+
+const char * Ast::get_kind_display( NodeKind kind ) {
+
+  switch( kind ) {
+
+  case( NodeKind::program )            : { return( "program" ); }
+  case( NodeKind::data_declaration )   : { return( "data_declaration" ); }
+  case( NodeKind::variable )           : { return( "variable" ); }
+  case( NodeKind::function )           : { return( "function" ); }
+  case( NodeKind::parameter_list )     : { return( "parameter_list" ); }
+  case( NodeKind::parameter )          : { return( "parameter" ); }
+  case( NodeKind::block )              : { return( "block" ); }
+  case( NodeKind::assignment )         : { return( "assignment" ); }
+  case( NodeKind::if_statement )       : { return( "if_statement" ); }
+  case( NodeKind::while_statement )    : { return( "while_statement" ); }
+  case( NodeKind::return_statement )   : { return( "return_statement" ); }
+  case( NodeKind::break_statement )    : { return( "break_statement" ); }
+  case( NodeKind::continue_statement ) : { return( "continue_statement" ); }
+  case( NodeKind::read_statement )     : { return( "read_statement" ); }
+  case( NodeKind::write_statement )    : { return( "write_statement" ); }
+  case( NodeKind::print_statement )    : { return( "print_statement" ); }
+  case( NodeKind::condition )          : { return( "condition" ); }
+  case( NodeKind::comparison )         : { return( "comparison" ); }
+  case( NodeKind::binary )             : { return( "binary" ); }
+  case( NodeKind::number )             : { return( "number" ); }
+  case( NodeKind::negative_number )    : { return( "negative_number" ); }
+  case( NodeKind::identifier )         : { return( "identifier" ); }
+  case( NodeKind::index )              : { return( "index" ); }
+  case( NodeKind::call )               : { return( "call" ); }
+  default                              : { return( "<<<PROGRAMMING ERROR>>>" ); }
+
+  }
+
+}
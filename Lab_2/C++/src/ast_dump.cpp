@@ -0,0 +1,34 @@
+#include "ast_file.h"
+
+#include <iostream>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// Print a tree saved by 'parser --ast-file'.  The file is mapped, not read, so
+// even a very large tree is available at once.  '--validate' checks the whole
+// file before it is trusted, for files that did not come from the parser.
+//-----------------------------------------------------------------------------
+
+auto main( int argc, char **argv ) -> int {
+
+  bool validate = (argc == 3) && (std::string( argv[1] ) == "--validate");
+
+  if( (argc != 2) && !validate ) {
+    std::cout << "Error:  Expecting [--validate] and a tree file name as the arguments." << std::endl;
+    return(1);
+  }
+
+  AstFile tree;
+  std::string error_message;
+
+  if( !tree.open( argv[argc-1], error_message ) ||
+      (validate && !tree.validate( error_message )) ) {
+    std::cout << "error :  " << error_message << std::endl;
+    return(2);
+  }
+
+  tree.print( std::cout );
+
+  return(0);
+
+}
@@ -0,0 +1,254 @@
+#include "ast_file.h"
+#include "ast.h"
+#include "token.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+// Every tree file starts with these 8 bytes, followed by the format version.
+// A reader whose byte order differs from the writer's reads byte_order as
+// something other than byte_order_mark.
+//-----------------------------------------------------------------------------
+
+static const char ast_file_magic[8] = { 'A', 'S', 'T', 'F', 'I', 'L', 'E', '\0' };
+static const std::uint32_t byte_order_mark = 0x01020304;
+
+//-----------------------------------------------------------------------------
+// The nodes go out as they are in memory.  The token table follows, with the
+// text of each token interned into the pool as it goes by.  The pool size is
+// only known at the end, so the header is written twice:  once to hold its
+// place and once more, complete, over the first.
+//-----------------------------------------------------------------------------
+
+bool write_ast_file( const std::string & filename,
+		     const Ast & tree,
+		     const token_vector & tokens,
+		     std::string & error_message ) {
+
+  std::ofstream file( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+
+  if( !file.is_open() ) {
+    error_message = "Failed to open file '" + filename + "' for writing.";
+    return(false);
+  }
+
+  AstFileHeader header;
+  std::memset( &header, 0, sizeof(header) );
+  std::memcpy( header.magic, ast_file_magic, sizeof(header.magic) );
+
+  header.version     = AstFile::version;
+  header.byte_order  = byte_order_mark;
+  header.node_count  = tree.size();
+  header.token_count = static_cast<std::uint32_t>( tokens.size() );
+
+  file.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+  file.write( reinterpret_cast<const char *>( tree.data() ), sizeof(AstNode) * tree.size() );
+
+  std::string pool;
+  std::unordered_map<std::string,std::uint32_t> interned;
+
+  for( const Token & token : tokens ) {
+
+    const std::string & name = token.get_token_name();
+    auto entry = interned.emplace( name, static_cast<std::uint32_t>( pool.size() ) );
+
+    if( entry.second ) {
+      pool += name;
+    }
+
+    AstFileToken record{ static_cast<std::uint32_t>( token.get_token_type() ),
+			 token.get_line_number(),
+			 entry.first->second,
+			 static_cast<std::uint32_t>( name.length() ) };
+
+    file.write( reinterpret_cast<const char *>( &record ), sizeof(record) );
+
+  }
+
+  file.write( pool.data(), pool.size() );
+
+  header.pool_size = static_cast<std::uint32_t>( pool.size() );
+
+  file.seekp( 0 );
+  file.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+  file.close();
+
+  if( !file ) {
+    error_message = "Failed to write file '" + filename + "'.";
+    return(false);
+  }
+
+  return(true);
+
+}
+
+AstFile::AstFile() :
+  mapping{nullptr}, mapping_size{0},
+  header{nullptr}, nodes{nullptr}, tokens{nullptr}, pool{nullptr}
+{
+}
+
+AstFile::~AstFile() {
+  close();
+}
+
+//-----------------------------------------------------------------------------
+// Map the file and point the sections into the mapping.  The pages are only
+// read when the tree is, so opening costs the same for any size of tree.
+//-----------------------------------------------------------------------------
+
+bool AstFile::open( const std::string & filename, std::string & error_message ) {
+
+  close();
+
+  int descriptor = ::open( filename.c_str(), O_RDONLY );
+
+  if( descriptor < 0 ) {
+    error_message = "Failed to open file '" + filename + "'.";
+    return(false);
+  }
+
+  struct stat status;
+
+  if( (fstat( descriptor, &status ) != 0) || (static_cast<std::size_t>( status.st_size ) < sizeof(AstFileHeader)) ) {
+    ::close( descriptor );
+    error_message = "File '" + filename + "' is not a tree file.";
+    return(false);
+  }
+
+  mapping_size = static_cast<std::size_t>( status.st_size );
+  mapping = mmap( nullptr, mapping_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+
+  ::close( descriptor );
+
+  if( mapping == MAP_FAILED ) {
+    mapping = nullptr;
+    error_message = "Failed to map file '" + filename + "'.";
+    return(false);
+  }
+
+  const char *base = static_cast<const char *>( mapping );
+  const AstFileHeader *candidate = reinterpret_cast<const AstFileHeader *>( base );
+
+  if( (std::memcmp( candidate->magic, ast_file_magic, sizeof(ast_file_magic) ) != 0) ||
+      (candidate->version != version) || (candidate->byte_order != byte_order_mark) ) {
+    close();
+    error_message = "File '" + filename + "' is not a tree file of version " + std::to_string( version ) +
+      " in this machine's byte order.";
+    return(false);
+  }
+
+  std::uint64_t expected = sizeof(AstFileHeader) +
+    static_cast<std::uint64_t>( candidate->node_count ) * sizeof(AstNode) +
+    static_cast<std::uint64_t>( candidate->token_count ) * sizeof(AstFileToken) +
+    candidate->pool_size;
+
+  if( expected != mapping_size ) {
+    close();
+    error_message = "File '" + filename + "' is truncated or corrupt.";
+    return(false);
+  }
+
+  header = candidate;
+  nodes  = reinterpret_cast<const AstNode *>( base + sizeof(AstFileHeader) );
+  tokens = reinterpret_cast<const AstFileToken *>( nodes + header->node_count );
+  pool   = reinterpret_cast<const char *>( tokens + header->token_count );
+
+  return(true);
+
+}
+
+void AstFile::close( void ) {
+
+  if( mapping != nullptr ) {
+    munmap( mapping, mapping_size );
+  }
+
+  mapping      = nullptr;
+  mapping_size = 0;
+  header       = nullptr;
+  nodes        = nullptr;
+  tokens       = nullptr;
+  pool         = nullptr;
+
+}
+
+//-----------------------------------------------------------------------------
+// Every link must be in range and no node may be linked to twice;  with node 0
+// never linked to at all, the nodes reachable from it then form a tree, so a
+// walk over it ends.  Token kinds and text ranges are checked as well.
+//-----------------------------------------------------------------------------
+
+bool AstFile::validate( std::string & error_message ) const {
+
+  std::uint32_t count = size();
+  std::vector<bool> linked( count, false );
+
+  for( std::uint32_t index = 0; index < count; ++index ) {
+
+    const AstNode & node = nodes[index];
+
+    if( node.kind > NodeKind::call ) {
+      error_message = "Node " + std::to_string( index ) + " is of no known kind.";
+      return(false);
+    }
+
+    if( (node.token != Ast::no_token) && (node.token >= get_token_count()) ) {
+      error_message = "Node " + std::to_string( index ) + " refers to a token out of range.";
+      return(false);
+    }
+
+    for( std::uint32_t link : { node.first_child, node.next_sibling } ) {
+
+      if( link == Ast::null_node ) {
+	continue;
+      }
+
+      if( (link >= count) || linked[link] ) {
+	error_message = "Node " + std::to_string( index ) + " has a bad link.";
+	return(false);
+      }
+
+      linked[link] = true;
+
+    }
+
+  }
+
+  for( std::uint32_t index = 0; index < get_token_count(); ++index ) {
+
+    const AstFileToken & token = tokens[index];
+
+    if( (token.type > static_cast<std::uint32_t>( TokenType::INITIAL )) ||
+	(static_cast<std::uint64_t>( token.name ) + token.length > header->pool_size) ) {
+      error_message = "Token " + std::to_string( index ) + " is corrupt.";
+      return(false);
+    }
+
+  }
+
+  return(true);
+
+}
+
+void AstFile::print( std::ostream & out ) const {
+
+  Ast::print_nodes( out, nodes, size(), [this]( std::ostream & out, std::uint32_t token ) {
+      if( token < get_token_count() ) {
+	out << " ";
+	out.write( get_token_text( token ), get_token( token ).length );
+      }
+    } );
+
+}
@@ -0,0 +1,727 @@
+#include "ast.h"
+#include "parser.h"
+#include "parse_main.h"
+#include "scanner.h"
+#include "token.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+//-----------------------------------------------------------------------------
+// The phases of a run of bin/parser, timed one by one:  reading the file,
+// Scanner::tokenize, Parser::parse, Parser::parse again with the tree, and
+// printing the result and the tree, here to a string so the terminal is not
+// what is measured.  What tree takes over parse is what the tree costs.
+//-----------------------------------------------------------------------------
+
+enum class Phase { load, scan, parse, tree, output };
+
+static const char * const phase_names[] = { "load", "scan", "parse", "tree", "output" };
+static const std::size_t phase_count = 5;
+
+//-----------------------------------------------------------------------------
+// A corpus is the files of a directory, or a single file.  Each repetition
+// times every phase over all its files, one sample per phase.
+//-----------------------------------------------------------------------------
+
+struct Corpus {
+  std::string              name;
+  std::vector<std::string> files;
+  std::uint64_t            bytes;
+  std::uint64_t            tokens;
+  std::vector<double>      samples[phase_count];
+};
+
+static bool list_corpus( const std::string & path, Corpus & corpus ) {
+
+  struct stat status;
+
+  if( stat( path.c_str(), &status ) != 0 ) {
+    std::cout << "Error:  Failed to open '" << path << "'." << std::endl;
+    return(false);
+  }
+
+  corpus.name = path;
+  corpus.bytes = 0;
+  corpus.tokens = 0;
+
+  if( !S_ISDIR( status.st_mode ) ) {
+    corpus.files.push_back( path );
+  } else {
+
+    DIR *directory = opendir( path.c_str() );
+
+    if( directory == nullptr ) {
+      std::cout << "Error:  Failed to open '" << path << "'." << std::endl;
+      return(false);
+    }
+
+    for( struct dirent *entry = readdir( directory ); entry != nullptr; entry = readdir( directory ) ) {
+      std::string file = path + "/" + entry->d_name;
+      if( (stat( file.c_str(), &status ) == 0) && S_ISREG( status.st_mode ) ) {
+	corpus.files.push_back( file );
+      }
+    }
+
+    closedir( directory );
+
+    std::sort( corpus.files.begin(), corpus.files.end() );
+
+  }
+
+  for( const std::string & file : corpus.files ) {
+    if( stat( file.c_str(), &status ) == 0 ) {
+      corpus.bytes += static_cast<std::uint64_t>( status.st_size );
+    }
+  }
+
+  return( !corpus.files.empty() );
+
+}
+
+//-----------------------------------------------------------------------------
+// One repetition over a corpus.  The scanner, parser and tree are kept from
+// one file to the next, as a long running parser would keep them.
+//-----------------------------------------------------------------------------
+
+static void run_corpus( Corpus & corpus, Scanner & scanner, Parser & parser, Ast & ast, bool record ) {
+
+  typedef std::chrono::steady_clock clock;
+
+  double elapsed[phase_count] = { 0, 0, 0, 0, 0 };
+  std::uint64_t tokens = 0;
+  string_vector program_text;
+  std::ostringstream out;
+  std::string error_message;
+
+  for( const std::string & file : corpus.files ) {
+
+    clock::time_point start = clock::now();
+
+    program_text.clear();
+    read_file_to_string_vector( file, program_text );
+
+    clock::time_point loaded = clock::now();
+
+    scanner.reset( program_text );
+    bool scanned = scanner.tokenize( error_message );
+
+    clock::time_point tokenized = clock::now();
+
+    parser.reset();
+    bool pass = scanned && parser.parse( scanner );
+
+    clock::time_point parsed = clock::now();
+
+    parser.reset();
+    pass = scanned && parser.parse( scanner, ast );
+
+    clock::time_point built = clock::now();
+
+    out.str( std::string{} );
+
+    if( pass ) {
+      out << "pass "
+	  << "variable " << parser.get_listener().get_variable_count() << " "
+	  << "function " << parser.get_listener().get_function_count() << " "
+	  << "statement " << parser.get_listener().get_statement_count() << std::endl;
+      ast.print( out, scanner.get_tokens() );
+    } else {
+      for( const ParseError & error : parser.get_errors() ) {
+	out << "error :  " << error.message << std::endl;
+      }
+    }
+
+    clock::time_point printed = clock::now();
+
+    elapsed[static_cast<std::size_t>( Phase::load )]   += std::chrono::duration<double>( loaded - start ).count();
+    elapsed[static_cast<std::size_t>( Phase::scan )]   += std::chrono::duration<double>( tokenized - loaded ).count();
+    elapsed[static_cast<std::size_t>( Phase::parse )]  += std::chrono::duration<double>( parsed - tokenized ).count();
+    elapsed[static_cast<std::size_t>( Phase::tree )]   += std::chrono::duration<double>( built - parsed ).count();
+    elapsed[static_cast<std::size_t>( Phase::output )] += std::chrono::duration<double>( printed - built ).count();
+
+    tokens += scanner.get_token_count();
+
+  }
+
+  if( record ) {
+    corpus.tokens = tokens;
+    for( std::size_t phase = 0; phase < phase_count; ++phase ) {
+      corpus.samples[phase].push_back( elapsed[phase] );
+    }
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// The median, and the 99th percentile by nearest rank, of sorted samples.
+//-----------------------------------------------------------------------------
+
+static double median( const std::vector<double> & sorted ) {
+
+  std::size_t middle = sorted.size() / 2;
+
+  return( (sorted.size() % 2 == 1) ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2 );
+
+}
+
+static double percentile_99( const std::vector<double> & sorted ) {
+
+  std::size_t rank = (sorted.size() * 99 + 99) / 100;
+
+  return( sorted[std::max<std::size_t>( rank, 1 ) - 1] );
+
+}
+
+//-----------------------------------------------------------------------------
+// A corpus name is a path, which may hold a '"' or a '\'.  A control
+// character in one becomes a space.
+//-----------------------------------------------------------------------------
+
+static void write_string( std::ostream & out, const std::string & text ) {
+
+  out << '"';
+
+  for( char c : text ) {
+    if( (c == '"') || (c == '\\') ) {
+      out << '\\' << c;
+    } else if( static_cast<unsigned char>( c ) < 0x20 ) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+
+  out << '"';
+
+}
+
+static void write_json( std::ostream & out, const std::vector<Corpus> & corpora, unsigned warmup, unsigned repeat ) {
+
+  out << std::setprecision( 9 );
+  out << "{\n  \"warmup\": " << warmup << ",\n  \"repeat\": " << repeat << ",\n  \"corpora\": [";
+
+  for( std::size_t index = 0; index < corpora.size(); ++index ) {
+
+    const Corpus & corpus = corpora[index];
+
+    out << (index ? "," : "") << "\n    {\n"
+	<< "      \"name\": ";
+
+    write_string( out, corpus.name );
+
+    out << ",\n"
+	<< "      \"files\": " << corpus.files.size() << ",\n"
+	<< "      \"bytes\": " << corpus.bytes << ",\n"
+	<< "      \"tokens\": " << corpus.tokens << ",\n"
+	<< "      \"phases\": {";
+
+    for( std::size_t phase = 0; phase < phase_count; ++phase ) {
+
+      std::vector<double> sorted( corpus.samples[phase] );
+      std::sort( sorted.begin(), sorted.end() );
+
+      out << (phase ? "," : "") << "\n        \"" << phase_names[phase] << "\": {"
+	  << " \"median_s\": " << median( sorted ) << ","
+	  << " \"p99_s\": " << percentile_99( sorted ) << ","
+	  << " \"mb_per_s\": " << (corpus.bytes / 1e6) / median( sorted ) << ","
+	  << " \"tokens_per_s\": " << corpus.tokens / median( sorted ) << ","
+	  << " \"samples_s\": [";
+
+      for( std::size_t sample = 0; sample < corpus.samples[phase].size(); ++sample ) {
+	out << (sample ? ", " : " ") << corpus.samples[phase][sample];
+      }
+
+      out << " ] }";
+
+    }
+
+    out << "\n      }\n    }";
+
+  }
+
+  out << "\n  ]\n}\n";
+
+}
+
+static void write_table( std::ostream & out, const std::vector<Corpus> & corpora ) {
+
+  out << std::left << std::setw( 40 ) << "corpus" << std::right
+      << std::setw( 8 ) << "phase" << std::setw( 12 ) << "median ms" << std::setw( 12 ) << "p99 ms"
+      << std::setw( 10 ) << "MB/s" << std::setw( 12 ) << "Mtokens/s" << std::endl;
+
+  out << std::fixed;
+
+  for( const Corpus & corpus : corpora ) {
+
+    for( std::size_t phase = 0; phase < phase_count; ++phase ) {
+
+      std::vector<double> sorted( corpus.samples[phase] );
+      std::sort( sorted.begin(), sorted.end() );
+
+      std::string name = (phase == 0) ? corpus.name : "";
+
+      if( name.length() > 39 ) {
+	name = "..." + name.substr( name.length() - 36 );
+      }
+
+      out << std::left << std::setw( 40 ) << name << std::right
+	  << std::setw( 8 ) << phase_names[phase]
+	  << std::setw( 12 ) << std::setprecision( 3 ) << median( sorted ) * 1e3
+	  << std::setw( 12 ) << percentile_99( sorted ) * 1e3
+	  << std::setw( 10 ) << std::setprecision( 1 ) << (corpus.bytes / 1e6) / median( sorted )
+	  << std::setw( 12 ) << std::setprecision( 2 ) << (corpus.tokens / 1e6) / median( sorted ) << std::endl;
+
+    }
+
+  }
+
+  out.unsetf( std::ios::fixed );
+
+}
+
+//-----------------------------------------------------------------------------
+// The JSON of '--json' read back, for '--baseline'.  Only the names, sizes
+// and samples of the corpora are kept, and what else there is is skipped, so
+// a baseline written by an older bench with other fields still reads.
+//-----------------------------------------------------------------------------
+
+static void skip_space( const std::string & text, std::size_t & at ) {
+  while( (at < text.length()) && std::isspace( static_cast<unsigned char>( text[at] ) ) ) {
+    ++at;
+  }
+}
+
+static bool expect( const std::string & text, std::size_t & at, char c ) {
+  skip_space( text, at );
+  if( (at < text.length()) && (text[at] == c) ) {
+    ++at;
+    return(true);
+  }
+  return(false);
+}
+
+static bool read_string( const std::string & text, std::size_t & at, std::string & value ) {
+
+  if( !expect( text, at, '"' ) ) {
+    return(false);
+  }
+
+  value.clear();
+
+  for( ; (at < text.length()) && (text[at] != '"'); ++at ) {
+    if( (text[at] == '\\') && (at+1 < text.length()) ) {
+      ++at;
+    }
+    value += text[at];
+  }
+
+  return( expect( text, at, '"' ) );
+
+}
+
+static bool read_number( const std::string & text, std::size_t & at, double & value ) {
+
+  skip_space( text, at );
+
+  const char *start = text.c_str() + at;
+  char *end = nullptr;
+
+  value = std::strtod( start, &end );
+  at += static_cast<std::size_t>( end - start );
+
+  return( end != start );
+
+}
+
+//-----------------------------------------------------------------------------
+// Calls 'member' with each key of an object, or 'item' for each item of an
+// array, which reads the value that follows.
+//-----------------------------------------------------------------------------
+
+template<typename Member>
+static bool read_object( const std::string & text, std::size_t & at, Member member ) {
+
+  if( !expect( text, at, '{' ) ) {
+    return(false);
+  }
+
+  if( expect( text, at, '}' ) ) {
+    return(true);
+  }
+
+  do {
+    std::string key;
+    if( !read_string( text, at, key ) || !expect( text, at, ':' ) || !member( key ) ) {
+      return(false);
+    }
+  } while( expect( text, at, ',' ) );
+
+  return( expect( text, at, '}' ) );
+
+}
+
+template<typename Item>
+static bool read_array( const std::string & text, std::size_t & at, Item item ) {
+
+  if( !expect( text, at, '[' ) ) {
+    return(false);
+  }
+
+  if( expect( text, at, ']' ) ) {
+    return(true);
+  }
+
+  do {
+    if( !item() ) {
+      return(false);
+    }
+  } while( expect( text, at, ',' ) );
+
+  return( expect( text, at, ']' ) );
+
+}
+
+static bool skip_value( const std::string & text, std::size_t & at ) {
+
+  skip_space( text, at );
+
+  if( at == text.length() ) {
+    return(false);
+  }
+
+  std::string string;
+  double number;
+
+  switch( text[at] ) {
+  case '{' : { return( read_object( text, at, [&]( const std::string & ) { return( skip_value( text, at ) ); } ) ); }
+  case '[' : { return( read_array( text, at, [&]() { return( skip_value( text, at ) ); } ) ); }
+  case '"' : { return( read_string( text, at, string ) ); }
+  case 't' : { at += 4; return( text.compare( at - 4, 4, "true" ) == 0 ); }
+  case 'f' : { at += 5; return( text.compare( at - 5, 5, "false" ) == 0 ); }
+  case 'n' : { at += 4; return( text.compare( at - 4, 4, "null" ) == 0 ); }
+  default  : { return( read_number( text, at, number ) ); }
+  }
+
+}
+
+static bool read_phase( const std::string & text, std::size_t & at, std::vector<double> & samples ) {
+
+  return( read_object( text, at, [&]( const std::string & key ) {
+	if( key != "samples_s" ) {
+	  return( skip_value( text, at ) );
+	}
+	return( read_array( text, at, [&]() {
+	      double sample = 0;
+	      bool read = read_number( text, at, sample );
+	      samples.push_back( sample );
+	      return( read );
+	    } ) );
+      } ) );
+
+}
+
+static bool read_corpus( const std::string & text, std::size_t & at, Corpus & corpus ) {
+
+  return( read_object( text, at, [&]( const std::string & key ) {
+	double number = 0;
+	if( key == "name" ) {
+	  return( read_string( text, at, corpus.name ) );
+	} else if( (key == "bytes") || (key == "tokens") ) {
+	  bool read = read_number( text, at, number );
+	  ((key == "bytes") ? corpus.bytes : corpus.tokens) = static_cast<std::uint64_t>( number );
+	  return( read );
+	} else if( key != "phases" ) {
+	  return( skip_value( text, at ) );
+	}
+	return( read_object( text, at, [&]( const std::string & phase_name ) {
+	      std::size_t phase = std::find( phase_names, phase_names + phase_count, phase_name ) - phase_names;
+	      return( (phase == phase_count) ? skip_value( text, at ) : read_phase( text, at, corpus.samples[phase] ) );
+	    } ) );
+      } ) );
+
+}
+
+static bool read_json( const std::string & filename, std::vector<Corpus> & corpora, std::string & error_message ) {
+
+  std::ifstream file( filename, std::ios::in | std::ios::binary );
+
+  if( !file.is_open() ) {
+    error_message = "Failed to open file '" + filename + "'.";
+    return(false);
+  }
+
+  std::string text( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+  std::size_t at = 0;
+
+  bool read = read_object( text, at, [&]( const std::string & key ) {
+      if( key != "corpora" ) {
+	return( skip_value( text, at ) );
+      }
+      return( read_array( text, at, [&]() {
+	    corpora.emplace_back();
+	    corpora.back().bytes = 0;
+	    corpora.back().tokens = 0;
+	    return( read_corpus( text, at, corpora.back() ) );
+	  } ) );
+    } );
+
+  if( !read ) {
+    error_message = "'" + filename + "' is not the JSON of a bench run, at byte " + std::to_string( at ) + ".";
+    return(false);
+  }
+
+  return(true);
+
+}
+
+//-----------------------------------------------------------------------------
+// The probability that samples as much slower than the baseline as 'now' are
+// would come from no change at all, by the Mann-Whitney U test:  one sided,
+// by the normal approximation with ties ranked by their mean and continuity
+// corrected.  It assumes nothing of how the times are distributed, and a few
+// outliers from a busy machine move it little.
+//-----------------------------------------------------------------------------
+
+static double mann_whitney( const std::vector<double> & baseline, const std::vector<double> & now ) {
+
+  std::vector<std::pair<double, bool>> all;
+
+  for( double sample : baseline ) {
+    all.emplace_back( sample, false );
+  }
+
+  for( double sample : now ) {
+    all.emplace_back( sample, true );
+  }
+
+  std::sort( all.begin(), all.end() );
+
+  double n = static_cast<double>( all.size() );
+  double n_now = static_cast<double>( now.size() );
+  double n_baseline = static_cast<double>( baseline.size() );
+  double rank_sum = 0;
+  double ties = 0;
+
+  for( std::size_t first = 0; first < all.size(); ) {
+
+    std::size_t last = first;
+
+    while( (last < all.size()) && (all[last].first == all[first].first) ) {
+      ++last;
+    }
+
+    double tied = static_cast<double>( last - first );
+    double rank = (first + 1 + last) / 2.0;
+
+    for( std::size_t index = first; index < last; ++index ) {
+      rank_sum += all[index].second ? rank : 0;
+    }
+
+    ties += tied * tied * tied - tied;
+    first = last;
+
+  }
+
+  double u = rank_sum - n_now * (n_now + 1) / 2;
+  double mean = n_now * n_baseline / 2;
+  double variance = n_now * n_baseline / 12 * ((n + 1) - ties / (n * (n - 1)));
+
+  if( variance <= 0 ) {
+    return(1);
+  }
+
+  double z = (u - mean - 0.5) / std::sqrt( variance );
+
+  return( std::erfc( z / std::sqrt( 2.0 ) ) / 2 );
+
+}
+
+//-----------------------------------------------------------------------------
+// A phase has regressed when its median is slower than the baseline's by
+// more than 'threshold', and the test finds that unlikely to be noise.
+// Corpora that are not in the baseline, or have changed since, are left out.
+//-----------------------------------------------------------------------------
+
+static const double significance = 0.01;
+
+static unsigned compare( std::ostream & out, const std::vector<Corpus> & baseline, const std::vector<Corpus> & corpora, double threshold ) {
+
+  unsigned regressions = 0;
+
+  out << std::endl << std::left << std::setw( 40 ) << "corpus" << std::right
+      << std::setw( 8 ) << "phase" << std::setw( 12 ) << "baseline ms" << std::setw( 12 ) << "now ms"
+      << std::setw( 10 ) << "change" << std::setw( 10 ) << "p" << std::endl;
+
+  for( const Corpus & corpus : corpora ) {
+
+    std::string name = corpus.name;
+
+    if( name.length() > 39 ) {
+      name = "..." + name.substr( name.length() - 36 );
+    }
+
+    auto before = std::find_if( baseline.begin(), baseline.end(), [&]( const Corpus & other ) { return( other.name == corpus.name ); } );
+
+    if( before == baseline.end() ) {
+      out << std::left << std::setw( 40 ) << name << std::right << "  not in the baseline" << std::endl;
+      continue;
+    }
+
+    if( (before->bytes != corpus.bytes) || (before->tokens != corpus.tokens) ) {
+      out << std::left << std::setw( 40 ) << name << std::right << "  changed since the baseline" << std::endl;
+      continue;
+    }
+
+    for( std::size_t phase = 0; phase < phase_count; ++phase ) {
+
+      if( before->samples[phase].empty() ) {
+	continue;
+      }
+
+      std::vector<double> sorted_before( before->samples[phase] );
+      std::vector<double> sorted( corpus.samples[phase] );
+      std::sort( sorted_before.begin(), sorted_before.end() );
+      std::sort( sorted.begin(), sorted.end() );
+
+      double change = median( sorted ) / median( sorted_before ) - 1;
+      double p = mann_whitney( before->samples[phase], corpus.samples[phase] );
+      bool regressed = (change > threshold) && (p < significance);
+
+      regressions += regressed ? 1 : 0;
+
+      out << std::left << std::setw( 40 ) << ((phase == 0) ? name : "") << std::right
+	  << std::setw( 8 ) << phase_names[phase] << std::fixed
+	  << std::setw( 12 ) << std::setprecision( 3 ) << median( sorted_before ) * 1e3
+	  << std::setw( 12 ) << median( sorted ) * 1e3
+	  << std::setw( 9 ) << std::setprecision( 1 ) << std::showpos << change * 100 << "%" << std::noshowpos
+	  << std::setw( 10 ) << std::setprecision( 4 ) << p
+	  << (regressed ? "  regression" : "") << std::endl;
+
+      out.unsetf( std::ios::fixed );
+
+    }
+
+  }
+
+  return( regressions );
+
+}
+
+auto main( int argc, char **argv ) -> int {
+
+  //-----------------------------------------------------------------------------
+  // Expect the corpora, directories or files, as the last arguments, optionally
+  // preceded by '--warmup <n>' for the repetitions left out of the results, 2
+  // when not given, '--repeat <n>' for the ones timed, 10 when not given, and
+  // '--json <file>' to write the results, samples included, to that file as
+  // well as printing the table, '--baseline <file>' to compare them with those
+  // of an earlier '--json', and '--threshold <percent>' for how much slower a
+  // phase may be than its baseline before it is a regression, 10 when not
+  // given.  With regressions the exit status is 2.
+  //-----------------------------------------------------------------------------
+
+  unsigned warmup = 2;
+  unsigned repeat = 10;
+  std::string json_filename;
+  std::string baseline_filename;
+  double threshold = 10;
+  int arg = 1;
+
+  for( ; (arg < argc) && (std::string( argv[arg] ).compare( 0, 2, "--" ) == 0); ++arg ) {
+
+    std::string option( argv[arg] );
+
+    if( (option == "--warmup") && (arg+1 < argc) ) {
+      warmup = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--repeat") && (arg+1 < argc) ) {
+      repeat = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--json") && (arg+1 < argc) ) {
+      json_filename = argv[++arg];
+    } else if( (option == "--baseline") && (arg+1 < argc) ) {
+      baseline_filename = argv[++arg];
+    } else if( (option == "--threshold") && (arg+1 < argc) ) {
+      threshold = std::strtod( argv[++arg], nullptr );
+    } else {
+      std::cout << "Error:  Unknown option '" << option << "'." << std::endl;
+      return(1);
+    }
+
+  }
+
+  if( (arg == argc) || (repeat == 0) ) {
+    std::cout << "Error:  Expecting at least one corpus and one repetition." << std::endl;
+    return(1);
+  }
+
+  std::vector<Corpus> baseline;
+  std::string error_message;
+
+  if( !baseline_filename.empty() && !read_json( baseline_filename, baseline, error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  std::vector<Corpus> corpora;
+
+  for( ; arg < argc; ++arg ) {
+    corpora.emplace_back();
+    if( !list_corpus( argv[arg], corpora.back() ) ) {
+      return(1);
+    }
+  }
+
+  Scanner scanner( string_vector{} );
+  Parser parser;
+  Ast ast;
+
+  for( Corpus & corpus : corpora ) {
+    for( unsigned run = 0; run < warmup + repeat; ++run ) {
+      run_corpus( corpus, scanner, parser, ast, run >= warmup );
+    }
+  }
+
+  write_table( std::cout, corpora );
+
+  if( !json_filename.empty() ) {
+
+    std::ofstream json( json_filename, std::ios::out | std::ios::trunc );
+
+    if( !json.is_open() ) {
+      std::cout << "Error:  Failed to open file '" << json_filename << "'." << std::endl;
+      return(1);
+    }
+
+    write_json( json, corpora, warmup, repeat );
+
+  }
+
+  if( !baseline_filename.empty() ) {
+
+    unsigned regressions = compare( std::cout, baseline, corpora, threshold / 100 );
+
+    if( regressions > 0 ) {
+      std::cout << "regression " << regressions << std::endl;
+      return(2);
+    }
+
+  }
+
+  return(0);
+
+}
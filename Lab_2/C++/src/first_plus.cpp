@@ -1,18 +1,17 @@
 #include "first_plus.h"
 #include "token.h" 
 
+#include <cstddef>
 #include <string>
-
-FIRST_PLUS_SET first_plus;
+#include <vector>
 
 //---------------------------------------------------------------------
 // The First Plus set for all the productions.  Underneath this is a
-// std::map of enums that point to token information.  The parser
-// simply reads from the global map to do all First Plus checks.
-// This routine initializes the global map.
+// std::map of enums that point to token information.  This routine
+// fills in the map, which first_plus_table() then flattens.
 //---------------------------------------------------------------------
 
-void initialize_first_plus_sets( void ) { 
+static void initialize_first_plus_sets( FIRST_PLUS_SET & first_plus ) { 
 
   first_plus[FirstPlus::program_start_p0] = {
     { TokenType::RESERVED_WORD, "binary" },
@@ -153,14 +152,6 @@ void initialize_first_plus_sets( void ) {
     { TokenType::SYMBOL, "{" }
   };
 
-  first_plus[FirstPlus::func_4_p0] = {
-    { TokenType::SYMBOL, ";" }
-  };
-
-  first_plus[FirstPlus::func_4_p1] = {
-    { TokenType::SYMBOL, "{" }
-  };
-
   first_plus[FirstPlus::func_list_p0] = {
     { TokenType::RESERVED_WORD, "binary" },
     { TokenType::RESERVED_WORD, "decimal" },
@@ -226,17 +217,6 @@ void initialize_first_plus_sets( void ) {
     { TokenType::SYMBOL, ";" }
   };
 
-  first_plus[FirstPlus::func_list_0_p0] = {
-    { TokenType::RESERVED_WORD, "binary" },
-    { TokenType::RESERVED_WORD, "decimal" },
-    { TokenType::RESERVED_WORD, "int" },
-    { TokenType::RESERVED_WORD, "void" }
-  };
-
-  first_plus[FirstPlus::func_list_0_p1] = {
-    { TokenType::EOF_TOK, "" }
-  };
-
   first_plus[FirstPlus::parameter_list_0_p0] = {
     { TokenType::IDENTIFIER, "" }
   };
@@ -276,29 +256,6 @@ void initialize_first_plus_sets( void ) {
     { TokenType::SYMBOL, "}" }
   };
 
-  first_plus[FirstPlus::func_5_p0] = {
-    { TokenType::RESERVED_WORD, "binary" },
-    { TokenType::RESERVED_WORD, "decimal" },
-    { TokenType::RESERVED_WORD, "int" },
-    { TokenType::RESERVED_WORD, "void" }
-  };
-
-  first_plus[FirstPlus::func_5_p1] = {
-    { TokenType::IDENTIFIER, "" },
-    { TokenType::RESERVED_WORD, "break" },
-    { TokenType::RESERVED_WORD, "continue" },
-    { TokenType::RESERVED_WORD, "if" },
-    { TokenType::RESERVED_WORD, "print" },
-    { TokenType::RESERVED_WORD, "read" },
-    { TokenType::RESERVED_WORD, "return" },
-    { TokenType::RESERVED_WORD, "while" },
-    { TokenType::RESERVED_WORD, "write" }
-  };
-
-  first_plus[FirstPlus::func_5_p2] = {
-    { TokenType::SYMBOL, "}" }
-  };
-
   first_plus[FirstPlus::func_p0] = {
     { TokenType::RESERVED_WORD, "binary" },
     { TokenType::RESERVED_WORD, "decimal" },
@@ -391,22 +348,6 @@ void initialize_first_plus_sets( void ) {
     { TokenType::RESERVED_WORD, "write" }
   };
 
-  first_plus[FirstPlus::func_6_p0] = {
-    { TokenType::IDENTIFIER, "" },
-    { TokenType::RESERVED_WORD, "break" },
-    { TokenType::RESERVED_WORD, "continue" },
-    { TokenType::RESERVED_WORD, "if" },
-    { TokenType::RESERVED_WORD, "print" },
-    { TokenType::RESERVED_WORD, "read" },
-    { TokenType::RESERVED_WORD, "return" },
-    { TokenType::RESERVED_WORD, "while" },
-    { TokenType::RESERVED_WORD, "write" }
-  };
-
-  first_plus[FirstPlus::func_6_p1] = {
-    { TokenType::SYMBOL, "}" }
-  };
-
   first_plus[FirstPlus::factor_1_p0] = {
     { TokenType::IDENTIFIER, "" },
     { TokenType::NUMBER, "" },
@@ -569,22 +510,6 @@ void initialize_first_plus_sets( void ) {
     { TokenType::SYMBOL, ")" }
   };
 
-  first_plus[FirstPlus::block_statements_0_p0] = {
-    { TokenType::IDENTIFIER, "" },
-    { TokenType::RESERVED_WORD, "break" },
-    { TokenType::RESERVED_WORD, "continue" },
-    { TokenType::RESERVED_WORD, "if" },
-    { TokenType::RESERVED_WORD, "print" },
-    { TokenType::RESERVED_WORD, "read" },
-    { TokenType::RESERVED_WORD, "return" },
-    { TokenType::RESERVED_WORD, "while" },
-    { TokenType::RESERVED_WORD, "write" }
-  };
-
-  first_plus[FirstPlus::block_statements_0_p1] = {
-    { TokenType::SYMBOL, "}" }
-  };
-
   first_plus[FirstPlus::non_empty_expr_list_0_p0] = {
     { TokenType::SYMBOL, "," }
   };
@@ -627,18 +552,51 @@ void initialize_first_plus_sets( void ) {
 
 }
 
+//---------------------------------------------------------------------
+// The table is built the first time it is asked for, and is never
+// changed after.  The C++ runtime sees to it that a local static is
+// initialized once, even when several threads get here at the same
+// time, so parsers may run on as many threads as wanted.  Each set
+// sits at the index of its FirstPlus name.
+//---------------------------------------------------------------------
+
+static std::vector<std::vector<Token>> flatten_first_plus_sets( void ) {
+
+  FIRST_PLUS_SET first_plus;
+  initialize_first_plus_sets( first_plus );
+
+  std::vector<std::vector<Token>> table;
+  table.reserve( first_plus.size() );
+
+  for( auto & entry : first_plus ) {
+    table.resize( static_cast<std::size_t>( entry.first ) );
+    table.push_back( entry.second );
+  }
+
+  return( table );
+
+}
+
+const std::vector<std::vector<Token>> & first_plus_table( void ) {
+
+  static const std::vector<std::vector<Token>> table = flatten_first_plus_sets();
+
+  return( table );
+
+}
+
 //---------------------------------------------------------------------
 // Given a token and a FirstPlus name enum, this routine compares to
 // see if the Token is inside the FirstPlus set.  It returns true
 // if there is match and false otherwise.
 //---------------------------------------------------------------------
 
-bool check_first_plus_set( Token & token, FirstPlus name ) {
+bool check_first_plus_set( const Token & token, FirstPlus name ) {
 
-  for( auto & t : first_plus[name] ) {
+  for( auto & t : first_plus_table()[static_cast<std::size_t>( name )] ) {
 
     TokenType ttype = t.get_token_type();
-    std::string tname = t.get_token_name();
+    const std::string & tname = t.get_token_name();
     
     if( ttype == token.get_token_type() ) { 
 
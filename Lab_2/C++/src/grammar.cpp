@@ -0,0 +1,799 @@
+#include "grammar.h"
+#include "grammar_transform.h"
+#include "memory_report.h"
+#include "token.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+// The cache file is a header, then the length of each symbol name, lhs,
+// offsets, rhs and the table, all as std::uint32_t, then the names back to
+// back.  The hash is of the grammar text the tables were computed from.  The
+// version changes with the tables load() computes from the same text:  from
+// version 2 on, they are of the grammar with equivalent nonterminals merged.
+//-----------------------------------------------------------------------------
+
+struct GrammarCacheHeader {
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint64_t grammar_hash;
+  std::uint32_t symbol_count;
+  std::uint32_t terminal_count;
+  std::uint32_t start;
+  std::uint32_t production_count;
+  std::uint32_t rhs_count;
+  std::uint32_t pool_size;
+};
+
+static const char grammar_cache_magic[8] = { 'L', 'L', '1', 'T', 'A', 'B', 'L', 'E' };
+static const std::uint32_t grammar_cache_version = 2;
+static const std::uint32_t byte_order_mark = 0x01020304;
+
+//-----------------------------------------------------------------------------
+// The names grammarLL1.txt gives the symbols that are not spelled out.
+//-----------------------------------------------------------------------------
+
+static const std::unordered_map<std::string, std::string> symbol_names =
+  {
+    { "semicolon",         ";"  },
+    { "comma",             ","  },
+    { "left_parenthesis",  "("  },
+    { "right_parenthesis", ")"  },
+    { "left_bracket",      "["  },
+    { "right_bracket",     "]"  },
+    { "left_brace",        "{"  },
+    { "right_brace",       "}"  },
+    { "plus_sign",         "+"  },
+    { "minus_sign",        "-"  },
+    { "star_sign",         "*"  },
+    { "forward_slash",     "/"  },
+    { "equal_sign",        "="  },
+    { "double_and_sign",   "&&" },
+    { "double_or_sign",    "||" }
+  };
+
+static std::uint64_t hash_text( const std::string & text ) {
+
+  std::uint64_t hash = 14695981039346656037ull;
+
+  for( char c : text ) {
+    hash = (hash ^ static_cast<unsigned char>( c )) * 1099511628211ull;
+  }
+
+  return( hash );
+
+}
+
+static bool is_nonterminal_name( const std::string & word ) {
+
+  return( (word.length() > 2) && (word.front() == '<') && (word.back() == '>') );
+
+}
+
+const std::uint32_t Grammar::no_symbol;
+const std::uint32_t Grammar::no_production;
+const std::uint32_t Grammar::epsilon;
+const std::uint32_t Grammar::text_terminal;
+
+Grammar::Grammar() :
+  names{}, terminal_count{0}, start{no_symbol},
+  lhs{}, offsets{}, rhs{}, table{}, from_cache{false},
+  first_plus{}, conflicts{}, type_terminals{}, text_terminals{}
+{
+}
+
+Grammar::~Grammar() {
+}
+
+//-----------------------------------------------------------------------------
+// A node of text_terminals is taken to be its entry and a link, and each
+// bucket a link.
+//-----------------------------------------------------------------------------
+
+std::size_t Grammar::get_memory_size( void ) const {
+
+  std::size_t bytes = string_vector_memory( names ) + string_vector_memory( conflicts ) +
+    (lhs.capacity() + offsets.capacity() + rhs.capacity() + table.capacity() + type_terminals.capacity()) * sizeof( std::uint32_t ) +
+    first_plus.capacity() * sizeof( std::vector<std::uint32_t> ) +
+    text_terminals.bucket_count() * sizeof( void * );
+
+  for( const std::vector<std::uint32_t> & set : first_plus ) {
+    bytes += set.capacity() * sizeof( std::uint32_t );
+  }
+
+  for( const auto & entry : text_terminals ) {
+    bytes += sizeof( entry ) + sizeof( void * ) + string_memory( entry.first );
+  }
+
+  return( bytes );
+
+}
+
+bool Grammar::load( const std::string & filename, std::string & error_message ) {
+
+  std::ifstream file( filename, std::ios::in | std::ios::binary );
+
+  if( !file.is_open() ) {
+    error_message = "Failed to open file '" + filename + "'.";
+    return(false);
+  }
+
+  std::string text( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+  std::uint64_t hash = hash_text( text );
+  std::string cache_filename = filename + ".tables";
+
+  from_cache = read_cache( cache_filename, hash );
+
+  trace_instant( from_cache ? "cache hit" : "cache miss", cache_filename );
+
+  if( from_cache ) {
+    first_plus.clear();
+    conflicts.clear();
+    match_terminals();
+    return(true);
+  }
+
+  rule_vector rules;
+
+  if( !read_grammar_rules( filename, text, rules, error_message ) ) {
+    return(false);
+  }
+
+  merge_equivalent( rules );
+
+  if( !build( rules, error_message ) ) {
+    error_message = "Grammar '" + filename + "':  " + error_message;
+    return(false);
+  }
+
+  if( !conflicts.empty() ) {
+    error_message = conflicts.front();
+    return(false);
+  }
+
+  write_cache( cache_filename, hash );
+
+  return(true);
+
+}
+
+//-----------------------------------------------------------------------------
+// The rules in the order they are first written, a rule written again adding
+// its productions to the first.  A line may hold more than one production,
+// each after a '|'.
+//-----------------------------------------------------------------------------
+
+bool read_grammar_rules( const std::string & filename,
+			 const std::string & text,
+			 rule_vector & rules,
+			 std::string & error_message ) {
+
+  std::unordered_map<std::string, std::size_t> index;
+  std::istringstream lines( text );
+  std::string line;
+  std::size_t rule = 0;
+  unsigned line_number = 0;
+
+  rules.clear();
+
+  while( std::getline( lines, line ) ) {
+
+    ++line_number;
+
+    std::string location = "Grammar '" + filename + "' line " + std::to_string( line_number ) + ":  ";
+
+    std::size_t annotation = line.find( '[' );
+    std::istringstream words( line.substr( 0, annotation ) );
+    std::vector<std::string> symbols{ std::istream_iterator<std::string>( words ), std::istream_iterator<std::string>() };
+
+    if( (symbols.size() >= 2) && is_nonterminal_name( symbols[0] ) && (symbols[1] == "-->") ) {
+      auto entry = index.emplace( symbols[0], rules.size() );
+      if( entry.second ) {
+	rules.push_back( GrammarRule{ symbols[0], {} } );
+      }
+      rule = entry.first->second;
+      symbols.erase( symbols.begin(), symbols.begin() + 2 );
+    } else if( !symbols.empty() && (symbols[0] == "|") ) {
+      if( rules.empty() ) {
+	error_message = location + "a production before any rule.";
+	return(false);
+      }
+      symbols.erase( symbols.begin() );
+    } else {
+      continue;
+    }
+
+    auto first = symbols.begin();
+
+    while( true ) {
+
+      auto last = std::find( first, symbols.end(), "|" );
+      std::vector<std::string> production( first, last );
+
+      if( production.empty() ) {
+	error_message = location + "a production with no symbols, EPSILON is written out.";
+	return(false);
+      }
+
+      if( (production.size() == 1) && (production[0] == "EPSILON") ) {
+	production.clear();
+      }
+
+      if( std::find( production.begin(), production.end(), "EPSILON" ) != production.end() ) {
+	error_message = location + "EPSILON among other symbols.";
+	return(false);
+      }
+
+      rules[rule].productions.push_back( production );
+
+      if( last == symbols.end() ) {
+	break;
+      }
+
+      first = last + 1;
+
+    }
+
+  }
+
+  if( rules.empty() ) {
+    error_message = "Grammar '" + filename + "' has no rules.";
+    return(false);
+  }
+
+  return(true);
+
+}
+
+//-----------------------------------------------------------------------------
+// Number the symbols:  the terminals in the order they first appear, eof among
+// them even if the grammar leaves it out, then the nonterminals in the order
+// of their rules.
+//-----------------------------------------------------------------------------
+
+bool Grammar::build( const rule_vector & rules, std::string & error_message ) {
+
+  std::vector<std::string> terminal_order;
+  std::unordered_map<std::string, std::uint32_t> ids;
+
+  if( rules.empty() ) {
+    error_message = "A grammar needs at least one rule.";
+    return(false);
+  }
+
+  for( const GrammarRule & rule : rules ) {
+    for( const std::vector<std::string> & production : rule.productions ) {
+      for( const std::string & symbol : production ) {
+	if( !is_nonterminal_name( symbol ) && ids.emplace( symbol, 0 ).second ) {
+	  terminal_order.push_back( symbol );
+	}
+      }
+    }
+  }
+
+  if( ids.emplace( "eof", 0 ).second ) {
+    terminal_order.push_back( "eof" );
+  }
+
+  names.clear();
+  ids.clear();
+
+  for( const std::string & name : terminal_order ) {
+    ids.emplace( name, static_cast<std::uint32_t>( names.size() ) );
+    names.push_back( name );
+  }
+
+  terminal_count = static_cast<std::uint32_t>( names.size() );
+
+  for( const GrammarRule & rule : rules ) {
+    ids.emplace( rule.name, static_cast<std::uint32_t>( names.size() ) );
+    names.push_back( rule.name );
+  }
+
+  start = terminal_count;
+
+  lhs.clear();
+  offsets.assign( 1, 0 );
+  rhs.clear();
+
+  for( const GrammarRule & rule : rules ) {
+
+    for( const std::vector<std::string> & production : rule.productions ) {
+
+      lhs.push_back( ids[rule.name] );
+
+      for( const std::string & symbol : production ) {
+	auto id = ids.find( symbol );
+	if( id == ids.end() ) {
+	  error_message = symbol + " is used but has no rule.";
+	  return(false);
+	}
+	rhs.push_back( id->second );
+      }
+
+      offsets.push_back( static_cast<std::uint32_t>( rhs.size() ) );
+
+    }
+
+  }
+
+  from_cache = false;
+
+  compute_table();
+  match_terminals();
+
+  return(true);
+
+}
+
+//-----------------------------------------------------------------------------
+// FIRST and FOLLOW by iterating to a fixed point, then the FIRST+ set of each
+// production into the table.  Two productions of a nonterminal in the same
+// cell is what keeps a grammar from being LL(1), and so is a nonterminal that
+// derives no string of terminals:  one with no productions, or only ones that
+// lead back to it, such as <A> --> <A> x.  A production with an empty FIRST+
+// set begins with such a nonterminal.
+//-----------------------------------------------------------------------------
+
+void Grammar::compute_table( void ) {
+
+  std::uint32_t nonterminal_count = get_nonterminal_count();
+  std::uint32_t eof = no_symbol;
+
+  for( std::uint32_t terminal = 0; terminal < terminal_count; ++terminal ) {
+    if( names[terminal] == "eof" ) {
+      eof = terminal;
+    }
+  }
+
+  typedef std::vector<bool> terminal_set;
+
+  std::vector<bool>         nullable( nonterminal_count, false );
+  std::vector<terminal_set> first( nonterminal_count, terminal_set( terminal_count, false ) );
+  std::vector<terminal_set> follow( nonterminal_count, terminal_set( terminal_count, false ) );
+
+  auto add = []( terminal_set & to, const terminal_set & from ) {
+    bool changed = false;
+    for( std::size_t terminal = 0; terminal < to.size(); ++terminal ) {
+      if( from[terminal] && !to[terminal] ) {
+	to[terminal] = true;
+	changed = true;
+      }
+    }
+    return( changed );
+  };
+
+  auto add_one = []( terminal_set & to, std::uint32_t terminal ) {
+    bool changed = !to[terminal];
+    to[terminal] = true;
+    return( changed );
+  };
+
+  //---------------------------------------------------------------------------
+  // The FIRST set of the symbols from 'symbol' to 'end', and whether they can
+  // all derive EPSILON.
+  //---------------------------------------------------------------------------
+
+  auto first_of = [&]( const std::uint32_t *symbol, const std::uint32_t *end, terminal_set & set ) {
+    for( ; symbol != end; ++symbol ) {
+      if( is_terminal( *symbol ) ) {
+	add_one( set, *symbol );
+	return(false);
+      }
+      add( set, first[*symbol - terminal_count] );
+      if( !nullable[*symbol - terminal_count] ) {
+	return(false);
+      }
+    }
+    return(true);
+  };
+
+  std::uint32_t production_count = static_cast<std::uint32_t>( lhs.size() );
+  bool changed = true;
+
+  while( changed ) {
+
+    changed = false;
+
+    for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+      std::uint32_t nonterminal = lhs[production] - terminal_count;
+      terminal_set set( terminal_count, false );
+
+      if( first_of( begin_of( production ), end_of( production ), set ) && !nullable[nonterminal] ) {
+	nullable[nonterminal] = true;
+	changed = true;
+      }
+
+      changed = add( first[nonterminal], set ) || changed;
+
+    }
+
+  }
+
+  std::vector<bool> productive( nonterminal_count, false );
+  changed = true;
+
+  while( changed ) {
+
+    changed = false;
+
+    for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+      std::uint32_t nonterminal = lhs[production] - terminal_count;
+
+      if( !productive[nonterminal] &&
+	  std::all_of( begin_of( production ), end_of( production ), [&]( std::uint32_t symbol ) {
+	      return( is_terminal( symbol ) || productive[symbol - terminal_count] );
+	    } ) ) {
+	productive[nonterminal] = true;
+	changed = true;
+      }
+
+    }
+
+  }
+
+  follow[start - terminal_count][eof] = true;
+  changed = true;
+
+  while( changed ) {
+
+    changed = false;
+
+    for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+      terminal_set trailer = follow[lhs[production] - terminal_count];
+
+      for( const std::uint32_t *symbol = end_of( production ); symbol != begin_of( production ); ) {
+
+	--symbol;
+
+	if( is_terminal( *symbol ) ) {
+	  trailer.assign( terminal_count, false );
+	  trailer[*symbol] = true;
+	  continue;
+	}
+
+	std::uint32_t nonterminal = *symbol - terminal_count;
+
+	changed = add( follow[nonterminal], trailer ) || changed;
+
+	if( !nullable[nonterminal] ) {
+	  trailer.assign( terminal_count, false );
+	}
+
+	add( trailer, first[nonterminal] );
+
+      }
+
+    }
+
+  }
+
+  table.assign( static_cast<std::size_t>( nonterminal_count ) * terminal_count, no_production );
+  first_plus.assign( production_count, std::vector<std::uint32_t>{} );
+  conflicts.clear();
+
+  for( std::uint32_t nonterminal = 0; nonterminal < nonterminal_count; ++nonterminal ) {
+    if( !productive[nonterminal] ) {
+      conflicts.push_back( "Grammar is not LL(1):  " + names[terminal_count + nonterminal] +
+			   (std::find( lhs.begin(), lhs.end(), terminal_count + nonterminal ) == lhs.end() ?
+			    " has no productions." : " derives no string of terminals.") );
+    }
+  }
+
+  for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+    std::uint32_t nonterminal = lhs[production] - terminal_count;
+    terminal_set set( terminal_count, false );
+
+    if( first_of( begin_of( production ), end_of( production ), set ) ) {
+      add( set, follow[nonterminal] );
+      first_plus[production].push_back( epsilon );
+    }
+
+    for( std::uint32_t terminal = 0; terminal < terminal_count; ++terminal ) {
+
+      if( !set[terminal] ) {
+	continue;
+      }
+
+      first_plus[production].push_back( terminal );
+
+      std::uint32_t & cell = table[static_cast<std::size_t>( nonterminal ) * terminal_count + terminal];
+
+      if( cell == no_production ) {
+	cell = production;
+      } else {
+	conflicts.push_back( "Grammar is not LL(1):  " + names[lhs[production]] + " has two productions for " +
+			     names[terminal] + "." );
+      }
+
+    }
+
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// A cache that is missing, stale, from another byte order or in any way
+// inconsistent is not used.  Every symbol and production in it is range
+// checked, so that a bad cache cannot make the parse go astray.
+//-----------------------------------------------------------------------------
+
+bool Grammar::read_cache( const std::string & filename, std::uint64_t hash ) {
+
+  std::ifstream file( filename, std::ios::in | std::ios::binary );
+
+  if( !file.is_open() ) {
+    return(false);
+  }
+
+  std::string data( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+  GrammarCacheHeader header;
+
+  if( data.size() < sizeof(header) ) {
+    return(false);
+  }
+
+  std::memcpy( &header, data.data(), sizeof(header) );
+
+  if( (std::memcmp( header.magic, grammar_cache_magic, sizeof(header.magic) ) != 0) ||
+      (header.version != grammar_cache_version) || (header.byte_order != byte_order_mark) ||
+      (header.grammar_hash != hash) ) {
+    return(false);
+  }
+
+  std::uint64_t symbol_count = header.symbol_count;
+  std::uint64_t production_count = header.production_count;
+  std::uint64_t table_size = (symbol_count - header.terminal_count) * header.terminal_count;
+
+  if( (header.terminal_count == 0) || (header.terminal_count >= symbol_count) ||
+      (header.start < header.terminal_count) || (header.start >= symbol_count) ||
+      (production_count == 0) ) {
+    return(false);
+  }
+
+  std::uint64_t words = symbol_count + production_count + (production_count + 1) + header.rhs_count + table_size;
+
+  if( sizeof(header) + words * sizeof(std::uint32_t) + header.pool_size != data.size() ) {
+    return(false);
+  }
+
+  std::vector<std::uint32_t> lengths( header.symbol_count );
+  const char *next = data.data() + sizeof(header);
+
+  auto take = [&next]( std::vector<std::uint32_t> & to, std::size_t count ) {
+    to.resize( count );
+    std::memcpy( to.data(), next, count * sizeof(std::uint32_t) );
+    next += count * sizeof(std::uint32_t);
+  };
+
+  take( lengths, header.symbol_count );
+  take( lhs, header.production_count );
+  take( offsets, header.production_count + 1 );
+  take( rhs, header.rhs_count );
+  take( table, table_size );
+
+  names.clear();
+
+  std::uint64_t pool_used = 0;
+
+  for( std::uint32_t length : lengths ) {
+    pool_used += length;
+    if( pool_used > header.pool_size ) {
+      return(false);
+    }
+    names.emplace_back( next, length );
+    next += length;
+  }
+
+  terminal_count = header.terminal_count;
+  start = header.start;
+
+  bool valid = (pool_used == header.pool_size) && (offsets[0] == 0) && (offsets[production_count] == header.rhs_count);
+
+  for( std::uint32_t production = 0; valid && (production < production_count); ++production ) {
+    valid = (lhs[production] >= terminal_count) && (lhs[production] < symbol_count) &&
+      (offsets[production] <= offsets[production + 1]);
+  }
+
+  for( std::uint32_t symbol : rhs ) {
+    valid = valid && (symbol < symbol_count);
+  }
+
+  for( std::size_t cell = 0; valid && (cell < table.size()); ++cell ) {
+    valid = (table[cell] == no_production) ||
+      ((table[cell] < production_count) && (lhs[table[cell]] == terminal_count + cell / terminal_count));
+  }
+
+  return( valid );
+
+}
+
+//-----------------------------------------------------------------------------
+// Written under a name of its own and renamed into place, so that a reader
+// never sees half a cache.
+//-----------------------------------------------------------------------------
+
+bool Grammar::write_cache( const std::string & filename, std::uint64_t hash ) const {
+
+  std::string pool;
+  std::vector<std::uint32_t> lengths;
+
+  for( const std::string & name : names ) {
+    lengths.push_back( static_cast<std::uint32_t>( name.length() ) );
+    pool += name;
+  }
+
+  GrammarCacheHeader header;
+  std::memset( &header, 0, sizeof(header) );
+  std::memcpy( header.magic, grammar_cache_magic, sizeof(header.magic) );
+
+  header.version          = grammar_cache_version;
+  header.byte_order       = byte_order_mark;
+  header.grammar_hash     = hash;
+  header.symbol_count     = static_cast<std::uint32_t>( names.size() );
+  header.terminal_count   = terminal_count;
+  header.start            = start;
+  header.production_count = static_cast<std::uint32_t>( lhs.size() );
+  header.rhs_count        = static_cast<std::uint32_t>( rhs.size() );
+  header.pool_size        = static_cast<std::uint32_t>( pool.size() );
+
+  std::string temporary = filename + "." + std::to_string( getpid() );
+  std::ofstream file( temporary, std::ios::out | std::ios::binary | std::ios::trunc );
+
+  if( !file.is_open() ) {
+    return(false);
+  }
+
+  auto put = [&file]( const std::vector<std::uint32_t> & from ) {
+    file.write( reinterpret_cast<const char *>( from.data() ), from.size() * sizeof(std::uint32_t) );
+  };
+
+  file.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+  put( lengths );
+  put( lhs );
+  put( offsets );
+  put( rhs );
+  put( table );
+  file.write( pool.data(), pool.size() );
+  file.close();
+
+  if( !file || (std::rename( temporary.c_str(), filename.c_str() ) != 0) ) {
+    std::remove( temporary.c_str() );
+    return(false);
+  }
+
+  return(true);
+
+}
+
+//-----------------------------------------------------------------------------
+// Rule by rule, the productions of a nonterminal being numbered together, with
+// the columns lined up as in grammarLL1.txt and each FIRST+ set in the order
+// of its names.
+//-----------------------------------------------------------------------------
+
+void Grammar::write( std::ostream & out ) const {
+
+  std::uint32_t production_count = get_production_count();
+  std::vector<std::string> texts( production_count );
+  std::size_t name_width = 0;
+  std::size_t text_width = 0;
+
+  for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+    for( const std::uint32_t *symbol = begin_of( production ); symbol != end_of( production ); ++symbol ) {
+      texts[production] += (texts[production].empty() ? "" : " ") + names[*symbol];
+    }
+
+    if( texts[production].empty() ) {
+      texts[production] = "EPSILON";
+    }
+
+    name_width = std::max( name_width, names[lhs[production]].length() );
+    text_width = std::max( text_width, texts[production].length() );
+
+  }
+
+  out << "The start state is " << names[start] << ".\n";
+
+  for( std::uint32_t production = 0; production < production_count; ++production ) {
+
+    std::string line;
+
+    if( (production == 0) || (lhs[production] != lhs[production - 1]) ) {
+      line = names[lhs[production]];
+      line.resize( name_width, ' ' );
+      line = "\n" + line + " --> ";
+    } else {
+      line.resize( name_width, ' ' );
+      line += "   | ";
+    }
+
+    line += texts[production];
+
+    if( !first_plus.empty() ) {
+
+      std::vector<std::string> set;
+
+      for( std::uint32_t terminal : first_plus[production] ) {
+	set.push_back( (terminal == epsilon) ? "EPSILON" : names[terminal] );
+      }
+
+      std::sort( set.begin(), set.end() );
+
+      line.resize( line.length() + text_width - texts[production].length(), ' ' );
+      line += "   [FIRST_PLUS = {";
+      for( const std::string & name : set ) {
+	line += " " + name;
+      }
+      line += " }]";
+
+    }
+
+    out << line << "\n";
+
+  }
+
+}
+
+std::string Grammar::get_spelling( std::uint32_t terminal ) const {
+
+  const std::string & name = names[terminal];
+  auto symbol = symbol_names.find( name );
+
+  if( (name == "ID") || (name == "NUMBER") || (name == "STRING") || (name == "eof") ) {
+    return( std::string{} );
+  }
+
+  return( (symbol != symbol_names.end()) ? symbol->second : name );
+
+}
+
+void Grammar::match_terminals( void ) {
+
+  type_terminals.assign( static_cast<std::size_t>( TokenType::INITIAL ) + 1, no_symbol );
+  type_terminals[static_cast<std::size_t>( TokenType::RESERVED_WORD )] = text_terminal;
+  type_terminals[static_cast<std::size_t>( TokenType::SYMBOL )] = text_terminal;
+
+  text_terminals.clear();
+
+  for( std::uint32_t terminal = 0; terminal < terminal_count; ++terminal ) {
+
+    const std::string & name = names[terminal];
+    auto symbol = symbol_names.find( name );
+
+    if( name == "ID" ) {
+      type_terminals[static_cast<std::size_t>( TokenType::IDENTIFIER )] = terminal;
+    } else if( name == "NUMBER" ) {
+      type_terminals[static_cast<std::size_t>( TokenType::NUMBER )] = terminal;
+    } else if( name == "STRING" ) {
+      type_terminals[static_cast<std::size_t>( TokenType::STRING )] = terminal;
+    } else if( name == "eof" ) {
+      type_terminals[static_cast<std::size_t>( TokenType::EOF_TOK )] = terminal;
+    } else if( symbol != symbol_names.end() ) {
+      text_terminals.emplace( symbol->second, terminal );
+    } else {
+      text_terminals.emplace( name, terminal );
+    }
+
+  }
+
+}
@@ -0,0 +1,70 @@
+#include "grammar.h"
+#include "grammar_transform.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// Take a grammar written the natural way to one the parser can load with
+// '--grammar':  left recursion eliminated, left factored, with equivalent
+// nonterminals merged and no rule that cannot be reached, each production with
+// its FIRST+ set.  Conflicts that remain are listed, and the grammar is
+// written all the same so they can be looked into, but the exit status is
+// then 2.
+//-----------------------------------------------------------------------------
+
+auto main( int argc, char **argv ) -> int {
+
+  if( argc != 3 ) {
+    std::cout << "Error:  Expecting a grammar file name and an output file name as the arguments." << std::endl;
+    return(1);
+  }
+
+  std::ifstream file( argv[1], std::ios::in | std::ios::binary );
+
+  if( !file.is_open() ) {
+    std::cout << "Error:  Failed to open file '" << argv[1] << "'." << std::endl;
+    return(1);
+  }
+
+  std::string text( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+  std::string error_message;
+  rule_vector rules;
+  Grammar grammar;
+
+  if( !read_grammar_rules( argv[1], text, rules, error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  eliminate_left_recursion( rules );
+  left_factor( rules );
+  merge_equivalent( rules );
+  remove_unreachable( rules );
+
+  if( !grammar.build( rules, error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  std::ofstream out( argv[2], std::ios::out | std::ios::binary | std::ios::trunc );
+
+  if( !out.is_open() ) {
+    std::cout << "Error:  Failed to open file '" << argv[2] << "'." << std::endl;
+    return(1);
+  }
+
+  grammar.write( out );
+
+  std::cout << "rule " << grammar.get_nonterminal_count()
+	    << " production " << grammar.get_production_count() << std::endl;
+
+  for( const std::string & conflict : grammar.get_conflicts() ) {
+    std::cout << "conflict :  " << conflict << std::endl;
+  }
+
+  return( grammar.get_conflicts().empty() ? 0 : 2 );
+
+}
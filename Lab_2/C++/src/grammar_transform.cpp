@@ -0,0 +1,418 @@
+#include "grammar_transform.h"
+
+#include "grammar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::string> production;
+
+static bool is_nonterminal_name( const std::string & word ) {
+
+  return( (word.length() > 2) && (word.front() == '<') && (word.back() == '>') );
+
+}
+
+//-----------------------------------------------------------------------------
+// <base> becomes <base_k>, with the first k no rule has taken.
+//-----------------------------------------------------------------------------
+
+static std::string new_name( const rule_vector & rules, const std::string & base ) {
+
+  std::string stem = base.substr( 0, base.length() - 1 ) + "_";
+
+  for( std::size_t k = 0; ; ++k ) {
+
+    std::string name = stem + std::to_string( k ) + ">";
+
+    if( std::none_of( rules.begin(), rules.end(), [&name]( const GrammarRule & rule ) { return( rule.name == name ); } ) ) {
+      return( name );
+    }
+
+  }
+
+}
+
+static void remove_repeats( std::vector<production> & productions ) {
+
+  std::vector<production> kept;
+
+  for( production & next : productions ) {
+    if( std::find( kept.begin(), kept.end(), next ) == kept.end() ) {
+      kept.push_back( std::move( next ) );
+    }
+  }
+
+  productions.swap( kept );
+
+}
+
+//-----------------------------------------------------------------------------
+// Whether a leftmost derivation from rule 'from' can begin with 'to'.
+//-----------------------------------------------------------------------------
+
+static bool leads_to( const rule_vector & rules,
+		      const std::unordered_map<std::string, std::size_t> & index,
+		      std::size_t from,
+		      const std::string & to ) {
+
+  std::vector<bool> seen( rules.size(), false );
+  std::vector<std::size_t> pending{ from };
+
+  seen[from] = true;
+
+  while( !pending.empty() ) {
+
+    std::size_t rule = pending.back();
+    pending.pop_back();
+
+    for( const production & next : rules[rule].productions ) {
+
+      if( next.empty() || !is_nonterminal_name( next.front() ) ) {
+	continue;
+      }
+
+      if( next.front() == to ) {
+	return(true);
+      }
+
+      auto lead = index.find( next.front() );
+
+      if( (lead != index.end()) && !seen[lead->second] ) {
+	seen[lead->second] = true;
+	pending.push_back( lead->second );
+      }
+
+    }
+
+  }
+
+  return(false);
+
+}
+
+//-----------------------------------------------------------------------------
+// The rules before rule i are free of left recursion by the time it is
+// reached, so substituting them for a leading nonterminal that leads back to
+// it leaves only immediate left recursion.  Each pass goes through the earlier
+// rules in order, and a rule's productions may begin with an earlier rule
+// again after a substitution, so it takes up to i passes.
+//-----------------------------------------------------------------------------
+
+void eliminate_left_recursion( rule_vector & rules ) {
+
+  std::unordered_map<std::string, std::size_t> index;
+
+  for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+    index.emplace( rules[rule].name, rule );
+  }
+
+  for( std::size_t i = 0; i < rules.size(); ++i ) {
+
+    bool substituted = true;
+
+    for( std::size_t pass = 0; substituted && (pass < i); ++pass ) {
+
+      substituted = false;
+
+      for( std::size_t j = 0; j < i; ++j ) {
+
+	if( !leads_to( rules, index, j, rules[i].name ) ) {
+	  continue;
+	}
+
+	std::vector<production> productions;
+
+	for( production & next : rules[i].productions ) {
+
+	  if( next.empty() || (next.front() != rules[j].name) ) {
+	    productions.push_back( std::move( next ) );
+	    continue;
+	  }
+
+	  for( const production & lead : rules[j].productions ) {
+	    productions.push_back( lead );
+	    productions.back().insert( productions.back().end(), next.begin() + 1, next.end() );
+	  }
+
+	  substituted = true;
+
+	}
+
+	rules[i].productions.swap( productions );
+
+      }
+
+    }
+
+    //-------------------------------------------------------------------------
+    // <A> --> <A> derives nothing, and is kept as it is, for build() to report
+    // rather than for the rule to be left with no productions.
+    //-------------------------------------------------------------------------
+
+    std::vector<production> recursive;
+    std::vector<production> others;
+    std::vector<production> cycles;
+
+    for( production & next : rules[i].productions ) {
+      if( next.empty() || (next.front() != rules[i].name) ) {
+	others.push_back( std::move( next ) );
+      } else if( next.size() > 1 ) {
+	recursive.emplace_back( next.begin() + 1, next.end() );
+      } else {
+	cycles.push_back( std::move( next ) );
+      }
+    }
+
+    remove_repeats( recursive );
+    remove_repeats( others );
+    remove_repeats( cycles );
+
+    if( recursive.empty() || others.empty() ) {
+      for( production & next : recursive ) {
+	next.insert( next.begin(), rules[i].name );
+	others.push_back( std::move( next ) );
+      }
+      others.insert( others.end(), cycles.begin(), cycles.end() );
+      rules[i].productions.swap( others );
+      continue;
+    }
+
+    if( (others.size() == 1) && others.front().empty() ) {
+      for( production & next : recursive ) {
+	next.push_back( rules[i].name );
+      }
+      recursive.emplace_back();
+      recursive.insert( recursive.end(), cycles.begin(), cycles.end() );
+      rules[i].productions.swap( recursive );
+      continue;
+    }
+
+    std::string tail = new_name( rules, rules[i].name );
+
+    for( production & next : others ) {
+      next.push_back( tail );
+    }
+
+    for( production & next : recursive ) {
+      next.push_back( tail );
+    }
+
+    recursive.emplace_back();
+    others.insert( others.end(), cycles.begin(), cycles.end() );
+
+    rules[i].productions.swap( others );
+    rules.insert( rules.begin() + i + 1, GrammarRule{ tail, recursive } );
+
+    index.clear();
+
+    for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+      index.emplace( rules[rule].name, rule );
+    }
+
+    ++i;
+
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// Rules split off a rule are inserted after it, and in turn factored, since
+// the suffixes they hold may begin alike too.
+//-----------------------------------------------------------------------------
+
+void left_factor( rule_vector & rules ) {
+
+  for( std::size_t i = 0; i < rules.size(); ++i ) {
+
+    std::size_t added = 0;
+
+    remove_repeats( rules[i].productions );
+
+    for( std::size_t first = 0; first < rules[i].productions.size(); ++first ) {
+
+      std::vector<production> & productions = rules[i].productions;
+
+      if( productions[first].empty() ) {
+	continue;
+      }
+
+      std::vector<std::size_t> group{ first };
+
+      for( std::size_t other = first + 1; other < productions.size(); ++other ) {
+	if( !productions[other].empty() && (productions[other].front() == productions[first].front()) ) {
+	  group.push_back( other );
+	}
+      }
+
+      if( group.size() == 1 ) {
+	continue;
+      }
+
+      std::size_t prefix = productions[first].size();
+
+      for( std::size_t other : group ) {
+	std::size_t shared = 0;
+	while( (shared < prefix) && (shared < productions[other].size()) &&
+	       (productions[other][shared] == productions[first][shared]) ) {
+	  ++shared;
+	}
+	prefix = shared;
+      }
+
+      GrammarRule suffixes{ new_name( rules, rules[i].name ), {} };
+
+      for( std::size_t other : group ) {
+	suffixes.productions.emplace_back( productions[other].begin() + prefix, productions[other].end() );
+      }
+
+      productions[first].resize( prefix );
+      productions[first].push_back( suffixes.name );
+
+      for( auto other = group.rbegin(); *other != first; ++other ) {
+	productions.erase( productions.begin() + *other );
+      }
+
+      rules.insert( rules.begin() + i + 1 + added, std::move( suffixes ) );
+      ++added;
+
+    }
+
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// Partition refinement.  All nonterminals start out in one set, and a set is
+// split by what its rules look like with each nonterminal written as the
+// number of its set, until no set splits.  A rule's productions are compared
+// in any order.  Terminals and nonterminals with no rule stand for themselves.
+//-----------------------------------------------------------------------------
+
+void merge_equivalent( rule_vector & rules ) {
+
+  std::unordered_map<std::string, std::size_t> index;
+
+  for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+    index.emplace( rules[rule].name, rule );
+  }
+
+  std::vector<std::size_t> set_of( rules.size(), 0 );
+  std::size_t set_count = 1;
+
+  for( ;; ) {
+
+    std::map<std::pair<std::size_t, std::vector<production>>, std::size_t> sets;
+    std::vector<std::size_t> next_set( rules.size() );
+
+    for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+
+      std::vector<production> shape;
+
+      for( const production & next : rules[rule].productions ) {
+	shape.emplace_back();
+	for( const std::string & symbol : next ) {
+	  auto found = index.find( symbol );
+	  shape.back().push_back( (found != index.end()) ? "<" + std::to_string( set_of[found->second] ) + ">" : symbol );
+	}
+      }
+
+      std::sort( shape.begin(), shape.end() );
+      shape.erase( std::unique( shape.begin(), shape.end() ), shape.end() );
+
+      next_set[rule] = sets.emplace( std::make_pair( set_of[rule], std::move( shape ) ), sets.size() ).first->second;
+
+    }
+
+    set_of.swap( next_set );
+
+    if( sets.size() == set_count ) {
+      break;
+    }
+
+    set_count = sets.size();
+
+  }
+
+  std::vector<std::size_t> kept( set_count, rules.size() );
+
+  for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+    if( kept[set_of[rule]] == rules.size() ) {
+      kept[set_of[rule]] = rule;
+    }
+  }
+
+  std::vector<std::string> names;
+  rule_vector merged;
+
+  for( const GrammarRule & rule : rules ) {
+    names.push_back( rule.name );
+  }
+
+  for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+
+    if( kept[set_of[rule]] != rule ) {
+      continue;
+    }
+
+    for( production & next : rules[rule].productions ) {
+      for( std::string & symbol : next ) {
+	auto found = index.find( symbol );
+	if( found != index.end() ) {
+	  symbol = names[kept[set_of[found->second]]];
+	}
+      }
+    }
+
+    remove_repeats( rules[rule].productions );
+    merged.push_back( std::move( rules[rule] ) );
+
+  }
+
+  rules.swap( merged );
+
+}
+
+void remove_unreachable( rule_vector & rules ) {
+
+  std::unordered_map<std::string, std::size_t> index;
+
+  for( std::size_t rule = 0; rule < rules.size(); ++rule ) {
+    index.emplace( rules[rule].name, rule );
+  }
+
+  std::unordered_set<std::string> reached;
+  std::vector<std::size_t> pending;
+
+  if( !rules.empty() ) {
+    reached.insert( rules.front().name );
+    pending.push_back( 0 );
+  }
+
+  while( !pending.empty() ) {
+
+    std::size_t rule = pending.back();
+    pending.pop_back();
+
+    for( const production & next : rules[rule].productions ) {
+      for( const std::string & symbol : next ) {
+	auto found = index.find( symbol );
+	if( (found != index.end()) && reached.insert( symbol ).second ) {
+	  pending.push_back( found->second );
+	}
+      }
+    }
+
+  }
+
+  rules.erase( std::remove_if( rules.begin(), rules.end(),
+			       [&reached]( const GrammarRule & rule ) { return( reached.count( rule.name ) == 0 ); } ),
+	       rules.end() );
+
+}
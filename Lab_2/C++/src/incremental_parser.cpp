@@ -0,0 +1,228 @@
+#include "incremental_parser.h"
+#include "parse_listener.h"
+#include "parser.h"
+#include "scanner.h"
+#include "token.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+IncrementalParser::IncrementalParser() :
+  max_nesting_depth{0},
+  top_level_pass{false}, top_level{}, top_level_errors{}, functions{}, braces{}, token_count{0},
+  pass{false}, totals{}, errors{}, reparsed{0}
+{
+}
+
+IncrementalParser::~IncrementalParser() {
+}
+
+//-----------------------------------------------------------------------------
+// Parse the top level, then each body unless a body of the last parse had
+// the very same tokens and passed.
+//-----------------------------------------------------------------------------
+
+bool IncrementalParser::parse( Scanner & scanner ) {
+
+  const token_vector & tokens = scanner.get_tokens();
+
+  Parser parser;
+  parser.set_max_nesting_depth( max_nesting_depth );
+
+  top_level_pass   = parser.preparse( scanner );
+  top_level        = parser.get_listener();
+  top_level_errors = parser.get_errors();
+
+  std::unordered_map<std::uint64_t, const Function *> cached;
+
+  for( const Function & function : functions ) {
+    if( function.pass ) {
+      cached.emplace( function.hash, &function );
+    }
+  }
+
+  std::vector<Function> parsed;
+  reparsed = 0;
+
+  for( const Parser::Body & body : parser.get_skipped_bodies() ) {
+
+    Function function{ body, hash_body( tokens, body ), true, CountListener{}, {} };
+    auto hit = cached.find( function.hash );
+
+    if( (hit != cached.end()) && (hit->second->body.last - hit->second->body.first == body.last - body.first) ) {
+      function.counts = hit->second->counts;
+      if( trace_enabled() ) {
+	trace_instant( "cache hit", "line " + std::to_string( tokens[body.first].get_line_number() ) );
+      }
+    } else {
+      parse_function( scanner, function );
+    }
+
+    parsed.push_back( std::move( function ) );
+
+  }
+
+  functions.swap( parsed );
+
+  braces.clear();
+
+  for( std::uint32_t index = 0; index < tokens.size(); ++index ) {
+    if( (tokens[index].get_token_type() == TokenType::SYMBOL) &&
+	((tokens[index].get_token_name() == "{") || (tokens[index].get_token_name() == "}")) ) {
+      braces.push_back( index );
+    }
+  }
+
+  token_count = tokens.size();
+
+  total();
+
+  return( pass );
+
+}
+
+//-----------------------------------------------------------------------------
+// Reparse the body the edit fell in, or everything that may have changed if
+// it did not fall in a single body or the top level had failed.
+//-----------------------------------------------------------------------------
+
+bool IncrementalParser::update( Scanner & scanner, std::uint32_t first, std::uint32_t removed, std::uint32_t inserted ) {
+
+  const token_vector & tokens = scanner.get_tokens();
+
+  if( !top_level_pass || (tokens.size() + removed != token_count + inserted) ) {
+    return( parse( scanner ) );
+  }
+
+  //---------------------------------------------------------------------------
+  // An edit that left the tokens as they were, say in a comment, has no body.
+  //---------------------------------------------------------------------------
+
+  auto edited = functions.end();
+
+  if( (removed != 0) || (inserted != 0) ) {
+
+    edited = std::upper_bound( functions.begin(), functions.end(), first, []( std::uint32_t index, const Function & function ) {
+	return( index <= function.body.first );
+      } );
+
+    if( (edited == functions.begin()) || (first + removed > (edited - 1)->body.last) ) {
+      return( parse( scanner ) );
+    }
+
+    --edited;
+
+    auto brace = std::lower_bound( braces.begin(), braces.end(), first );
+
+    if( (brace != braces.end()) && (*brace < first + removed) ) {
+      return( parse( scanner ) );
+    }
+
+    for( std::uint32_t index = first; index < first + inserted; ++index ) {
+      if( (tokens[index].get_token_type() == TokenType::SYMBOL) &&
+	  ((tokens[index].get_token_name() == "{") || (tokens[index].get_token_name() == "}")) ) {
+	return( parse( scanner ) );
+      }
+    }
+
+    //-------------------------------------------------------------------------
+    // Move everything after the edit along.
+    //-------------------------------------------------------------------------
+
+    std::uint32_t shift = inserted - removed;
+
+    edited->body.last += shift;
+
+    for( auto function = edited + 1; function != functions.end(); ++function ) {
+      function->body.first += shift;
+      function->body.last  += shift;
+    }
+
+    for( ; brace != braces.end(); ++brace ) {
+      *brace += shift;
+    }
+
+  }
+
+  token_count = tokens.size();
+
+  reparsed = 0;
+
+  for( Function & function : functions ) {
+    if( ((edited != functions.end()) && (&function == &*edited)) || !function.pass ) {
+      function.hash = hash_body( tokens, function.body );
+      parse_function( scanner, function );
+    }
+  }
+
+  total();
+
+  return( pass );
+
+}
+
+void IncrementalParser::parse_function( Scanner & scanner, Function & function ) {
+
+  Parser parser;
+  parser.set_max_nesting_depth( max_nesting_depth );
+
+  function.pass   = parser.parse_body( scanner, function.body );
+  function.counts = parser.get_listener();
+  function.errors = parser.get_errors();
+
+  ++reparsed;
+
+}
+
+void IncrementalParser::total( void ) {
+
+  pass   = top_level_pass;
+  totals = top_level;
+  errors = top_level_errors;
+
+  for( const Function & function : functions ) {
+    pass = pass && function.pass;
+    totals.merge( function.counts );
+    errors.insert( errors.end(), function.errors.begin(), function.errors.end() );
+  }
+
+  std::stable_sort( errors.begin(), errors.end(), []( const ParseError & a, const ParseError & b ) {
+      return( a.token < b.token );
+    } );
+
+  pass = pass && errors.empty();
+
+}
+
+//-----------------------------------------------------------------------------
+// FNV-1a over the type and text of the tokens between the braces.  Line
+// numbers are left out, so a body that only moved keeps its hash.
+//-----------------------------------------------------------------------------
+
+std::uint64_t IncrementalParser::hash_body( const token_vector & tokens, const Parser::Body & body ) {
+
+  std::uint64_t hash = 14695981039346656037ull;
+
+  auto mix = [&hash]( unsigned char byte ) {
+    hash = (hash ^ byte) * 1099511628211ull;
+  };
+
+  for( std::uint32_t index = body.first + 1; index < body.last; ++index ) {
+
+    mix( static_cast<unsigned char>( tokens[index].get_token_type() ) );
+
+    for( char c : tokens[index].get_token_name() ) {
+      mix( static_cast<unsigned char>( c ) );
+    }
+
+    mix( 0xff );
+
+  }
+
+  return( hash );
+
+}
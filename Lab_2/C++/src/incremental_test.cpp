@@ -0,0 +1,197 @@
+#include "incremental_parser.h"
+#include "parser.h"
+#include "parse_main.h"
+#include "scanner.h"
+#include "token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Lines an edit puts in, to change a statement, add or remove a brace, a
+// function or a declaration, or to leave an error behind.
+//-----------------------------------------------------------------------------
+
+static const char * const edit_lines[] = {
+  "",
+  "x = 1;",
+  "x = (",
+  "{",
+  "}",
+  "int q;",
+  "return;",
+  "write(3);",
+  "if (a < b) { y = 2; }",
+  "while (i < 10) { i = i + 1; }",
+  "int g(int a) { return a; }",
+  "void h(void) {"
+};
+
+static const std::size_t edit_line_count = sizeof( edit_lines ) / sizeof( edit_lines[0] );
+
+//-----------------------------------------------------------------------------
+// The result of a parse as bin/parser would print it.
+//-----------------------------------------------------------------------------
+
+static std::string describe( bool pass, CountListener & listener, const std::vector<ParseError> & errors ) {
+
+  std::ostringstream out;
+
+  out << (pass ? "pass " : "fail ")
+      << "variable " << listener.get_variable_count() << " "
+      << "function " << listener.get_function_count() << " "
+      << "statement " << listener.get_statement_count() << std::endl;
+
+  for( const ParseError & error : errors ) {
+    out << "error :  " << error.message << std::endl;
+  }
+
+  return( out.str() );
+
+}
+
+static bool same_token( const Token & a, const Token & b ) {
+
+  return( (a.get_token_type() == b.get_token_type()) && (a.get_token_name() == b.get_token_name()) );
+
+}
+
+//-----------------------------------------------------------------------------
+// Each edit replaces a line, or inserts one before it, and is given to
+// update() as the tokens between those the input before and after have in
+// common at either end.  Edits that leave the input unscannable are not
+// made, and an input that is unscannable to begin with is skipped.
+//-----------------------------------------------------------------------------
+
+static bool test_file( const std::string & filename, unsigned edits, std::mt19937_64 & random ) {
+
+  string_vector text;
+  std::string error_message;
+
+  if( !read_file_to_string_vector( filename, text ) || text.empty() ) {
+    std::cout << "Error:  Failed to read file '" << filename << "'." << std::endl;
+    return(false);
+  }
+
+  Scanner before( text );
+
+  if( !before.tokenize( error_message ) ) {
+    std::cout << "skip " << filename << ":  " << error_message << std::endl;
+    return(true);
+  }
+
+  IncrementalParser incremental;
+  std::size_t reparsed = 0;
+
+  incremental.parse( before );
+
+  for( unsigned edit = 0; edit < edits; ++edit ) {
+
+    string_vector edited( text );
+    std::size_t line = random() % edited.size();
+    const char *line_text = edit_lines[random() % edit_line_count];
+
+    if( random() % 2 == 0 ) {
+      edited[line] = line_text;
+    } else {
+      edited.insert( edited.begin() + line, line_text );
+    }
+
+    Scanner after( edited );
+
+    if( !after.tokenize( error_message ) ) {
+      continue;
+    }
+
+    std::uint32_t before_count = before.get_token_count();
+    std::uint32_t after_count = after.get_token_count();
+    std::uint32_t first = 0;
+    std::uint32_t last = 0;
+
+    while( (first < before_count) && (first < after_count) && same_token( before.get_token( first ), after.get_token( first ) ) ) {
+      ++first;
+    }
+
+    while( (last < before_count - first) && (last < after_count - first) &&
+	   same_token( before.get_token( before_count - last - 1 ), after.get_token( after_count - last - 1 ) ) ) {
+      ++last;
+    }
+
+    incremental.update( after, first, before_count - first - last, after_count - first - last );
+    reparsed += incremental.get_reparsed_count();
+
+    Parser parser;
+    parser.preparse( after );
+    bool pass = parser.finish();
+
+    std::string expected = describe( pass, parser.get_listener(), parser.get_errors() );
+    std::string result = describe( incremental.get_pass(), incremental.get_listener(), incremental.get_errors() );
+
+    if( result != expected ) {
+      std::cout << "fail " << filename << " edit " << edit << " line " << line + 1 << " '" << line_text << "'" << std::endl
+		<< "update :" << std::endl << result << "parse :" << std::endl << expected;
+      return(false);
+    }
+
+    text.swap( edited );
+    before.reset( text );
+    before.tokenize( error_message );
+
+  }
+
+  std::cout << "pass " << filename << " edits " << edits << " reparsed " << reparsed << std::endl;
+
+  return(true);
+
+}
+
+auto main( int argc, char **argv ) -> int {
+
+  //-----------------------------------------------------------------------------
+  // Expect the files to edit as the last arguments, optionally preceded by
+  // '--edits <n>' for the edits made to each, 100 when not given, and
+  // '--seed <n>'.  After every edit the result of IncrementalParser::update()
+  // has to be the one of a Parser that parses the edited input from scratch
+  // with preparse() and finish().  Otherwise the exit status is 1.
+  //-----------------------------------------------------------------------------
+
+  unsigned edits = 100;
+  std::uint64_t seed = 1;
+  int arg = 1;
+
+  for( ; (arg < argc) && (std::string( argv[arg] ).compare( 0, 2, "--" ) == 0); ++arg ) {
+
+    std::string option( argv[arg] );
+
+    if( (option == "--edits") && (arg+1 < argc) ) {
+      edits = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--seed") && (arg+1 < argc) ) {
+      seed = std::strtoull( argv[++arg], nullptr, 10 );
+    } else {
+      std::cout << "Error:  Unknown option '" << option << "'." << std::endl;
+      return(1);
+    }
+
+  }
+
+  if( arg == argc ) {
+    std::cout << "Error:  Expecting at least one file name." << std::endl;
+    return(1);
+  }
+
+  std::mt19937_64 random( seed );
+  bool passed = true;
+
+  for( ; arg < argc; ++arg ) {
+    passed = test_file( argv[arg], edits, random ) && passed;
+  }
+
+  return( passed ? 0 : 1 );
+
+}
@@ -0,0 +1,61 @@
+#include "memory_report.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+//-----------------------------------------------------------------------------
+// ru_maxrss is in kilobytes on Linux, in bytes on macOS.
+//-----------------------------------------------------------------------------
+
+std::size_t peak_resident_size( void ) {
+
+  struct rusage usage;
+
+  if( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+    return(0);
+  }
+
+#ifdef __APPLE__
+  return( static_cast<std::size_t>( usage.ru_maxrss ) );
+#else
+  return( static_cast<std::size_t>( usage.ru_maxrss ) * 1024 );
+#endif
+
+}
+
+static void print_memory_line( std::ostream & out, const char *name, std::size_t bytes,
+			       std::uint64_t source_bytes, std::uint64_t tokens ) {
+
+  out << std::left << std::setw( 20 ) << name << std::right
+      << std::setw( 14 ) << bytes
+      << std::setw( 16 ) << (source_bytes ? static_cast<double>( bytes ) / source_bytes : 0.0)
+      << std::setw( 12 ) << (tokens ? static_cast<double>( bytes ) / tokens : 0.0) << std::endl;
+
+}
+
+void print_memory_report( std::ostream & out, const std::vector<MemoryItem> & items,
+			  std::uint64_t source_bytes, std::uint64_t tokens ) {
+
+  std::size_t total = 0;
+
+  out << std::left << std::setw( 20 ) << "memory" << std::right << std::setw( 14 ) << "bytes"
+      << std::setw( 16 ) << "per source byte" << std::setw( 12 ) << "per token" << std::endl;
+
+  out << std::fixed << std::setprecision( 2 );
+
+  for( const MemoryItem & item : items ) {
+    print_memory_line( out, item.name, item.bytes, source_bytes, tokens );
+    total += item.bytes;
+  }
+
+  print_memory_line( out, "total", total, source_bytes, tokens );
+  print_memory_line( out, "peak resident", peak_resident_size(), source_bytes, tokens );
+
+  out.unsetf( std::ios::fixed );
+
+}
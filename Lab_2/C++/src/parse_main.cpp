@@ -1,103 +1,461 @@
+#include "allocation_counter.h"
+#include "ast.h"
+#include "ast_file.h"
+#include "first_plus.h"
+#include "grammar.h"
+#include "memory_report.h"
 #include "parser.h"
 #include "parse_main.h"
+#include "perf_counters.h"
 #include "scanner.h"
+#include "table_parser.h"
 #include "token.h"
+#include "trace.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
+//-----------------------------------------------------------------------------
+// The counters of each phase, from one sample to the next:  reading the file,
+// tokenizing and parsing.  Each is given in total, per token and per byte of
+// the input, with the instructions per cycle.  A counter the machine does not
+// have is left out, and named at the end.
+//-----------------------------------------------------------------------------
+
+static void print_perf_counters( std::ostream & out, const PerfCounters & counters, const PerfSample samples[],
+				 std::uint64_t tokens, std::uint64_t bytes ) {
+
+  static const char * const phase_names[] = { "load", "tokenize", "parse" };
+
+  out << std::left << std::setw( 10 ) << "phase" << std::setw( 16 ) << "counter" << std::right
+      << std::setw( 16 ) << "total" << std::setw( 12 ) << "per token" << std::setw( 12 ) << "per byte" << std::endl;
+
+  out << std::fixed << std::setprecision( 3 );
+
+  for( std::size_t phase = 0; phase < 3; ++phase ) {
+
+    const PerfSample & before = samples[phase];
+    const PerfSample & after = samples[phase + 1];
+
+    for( std::size_t event = 0; event < perf_event_count; ++event ) {
+
+      if( !counters.is_available( static_cast<PerfEvent>( event ) ) ) {
+	continue;
+      }
+
+      std::uint64_t count = PerfCounters::difference( before, after, static_cast<PerfEvent>( event ) );
+
+      out << std::left << std::setw( 10 ) << phase_names[phase]
+	  << std::setw( 16 ) << PerfCounters::get_name( static_cast<PerfEvent>( event ) ) << std::right
+	  << std::setw( 16 ) << count
+	  << std::setw( 12 ) << (tokens ? static_cast<double>( count ) / tokens : 0.0)
+	  << std::setw( 12 ) << (bytes ? static_cast<double>( count ) / bytes : 0.0) << std::endl;
+
+    }
+
+    if( counters.is_available( PerfEvent::cycles ) && counters.is_available( PerfEvent::instructions ) ) {
+
+      std::uint64_t cycle_count = PerfCounters::difference( before, after, PerfEvent::cycles );
+      std::uint64_t instruction_count = PerfCounters::difference( before, after, PerfEvent::instructions );
+
+      out << std::left << std::setw( 10 ) << phase_names[phase] << std::setw( 16 ) << "IPC" << std::right
+	  << std::setw( 16 ) << (cycle_count ? static_cast<double>( instruction_count ) / cycle_count : 0.0)
+	  << std::endl;
+
+    }
+
+  }
+
+  out.unsetf( std::ios::fixed );
+
+  std::string missing;
+
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+    if( !counters.is_available( static_cast<PerfEvent>( event ) ) ) {
+      missing += (missing.empty() ? "" : " ") + std::string( PerfCounters::get_name( static_cast<PerfEvent>( event ) ) );
+    }
+  }
+
+  if( !missing.empty() ) {
+    out << "not counted :  " << missing << std::endl;
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// The structures of a parse for '--mem-report':  the lines read, as the vector
+// and the text its strings hold, the scanner's copy of them and its tokens,
+// the FIRST+ sets, and the tree or the grammar, whichever there is.
+//-----------------------------------------------------------------------------
+
+static std::vector<MemoryItem> memory_items( const string_vector & program_text, const Scanner & scanner,
+					     const Ast *ast, const Grammar *grammar ) {
+
+  std::size_t line_vector = program_text.capacity() * sizeof( std::string );
+  std::size_t first_plus = first_plus_table().capacity() * sizeof( std::vector<Token> );
+
+  for( const std::vector<Token> & set : first_plus_table() ) {
+    first_plus += token_vector_memory( set );
+  }
+
+  std::vector<MemoryItem> items = {
+    MemoryItem{ "line vector", line_vector },
+    MemoryItem{ "source text", string_vector_memory( program_text ) - line_vector },
+    MemoryItem{ "scanner text", scanner.get_text_memory_size() },
+    MemoryItem{ "tokens", scanner.get_token_memory_size() },
+    MemoryItem{ "FIRST+ tables", first_plus }
+  };
+
+  if( ast != nullptr ) {
+    items.push_back( MemoryItem{ "tree", ast->get_memory_size() } );
+  }
+
+  if( grammar != nullptr ) {
+    items.push_back( MemoryItem{ "grammar", grammar->get_memory_size() } );
+  }
+
+  return( items );
+
+}
+
+static void print_usage( std::ostream & out, const char *program ) {
+
+  out << "Usage:  " << program << " [--max-nesting <depth>] [--threads <count>] [--preparse]" << std::endl
+      << "          [--ast] [--ast-file <file>] [--grammar <file>] [--allocations]" << std::endl
+      << "          [--perf-counters] [--trace <file>] [--mem-report] <input file>" << std::endl;
+
+}
+
 auto main( int argc, char **argv ) -> int {
 
   //-----------------------------------------------------------------------------
-  // Expect exactly two arguments, this program's name and the input text file.
+  // Expect the input text file as the last argument, optionally preceded by
+  // '--max-nesting <depth>' to bound how deeply blocks and expressions may nest,
+  // '--ast' to print the parse tree of a passing program, '--ast-file <file>'
+  // to save it in binary form, '--threads <count>' to parse function bodies
+  // on that many threads and '--preparse' to report the top level declarations
+  // before the function bodies are parsed.  The tree is then of the top level
+  // only, with empty function bodies.  '--allocations' scans and parses the
+  // input again and reports the heap allocations of the last pass.
+  // '--grammar <file>' parses by the LL(1) grammar in that file instead of
+  // the grammar built into the parser, see grammar.h, and reports the number
+  // of productions expanded.  '--perf-counters' reports the hardware counters
+  // of reading, tokenizing and parsing, see perf_counters.h, or why there are
+  // none.  '--trace <file>' writes a timeline of the phases and of each
+  // function body, on whichever thread parsed it, to that file, see trace.h.
+  // '--mem-report' reports the memory of each structure of the parse, see
+  // memory_report.h.
   //-----------------------------------------------------------------------------
 
-  if( argc != 2 ) {
-    std::cout << "Error:  Expecting input file name as the sole argument." << std::endl;
+  unsigned max_nesting_depth = 0;
+  unsigned thread_count = 0;
+  bool preparse = false;
+  bool print_ast = false;
+  bool count_allocations = false;
+  bool count_events = false;
+  bool report_memory = false;
+  std::string ast_filename;
+  std::string grammar_filename;
+  std::string trace_filename;
+  int arg = 1;
+
+  for( ; arg < argc-1; ++arg ) {
+
+    std::string option( argv[arg] );
+
+    if( (option == "--max-nesting") && (arg+1 < argc-1) ) {
+      max_nesting_depth = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( option == "--ast" ) {
+      print_ast = true;
+    } else if( option == "--preparse" ) {
+      preparse = true;
+    } else if( option == "--allocations" ) {
+      count_allocations = true;
+    } else if( option == "--perf-counters" ) {
+      count_events = true;
+    } else if( option == "--mem-report" ) {
+      report_memory = true;
+    } else if( (option == "--ast-file") && (arg+1 < argc-1) ) {
+      ast_filename = argv[++arg];
+    } else if( (option == "--grammar") && (arg+1 < argc-1) ) {
+      grammar_filename = argv[++arg];
+    } else if( (option == "--threads") && (arg+1 < argc-1) ) {
+      thread_count = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--trace") && (arg+1 < argc-1) ) {
+      trace_filename = argv[++arg];
+    } else {
+      std::cout << "Error:  Unknown option '" << option << "', or its value is missing." << std::endl;
+      print_usage( std::cout, argv[0] );
+      return(1);
+    }
+
+  }
+
+  if( arg != argc-1 ) {
+    std::cout << "Error:  Expecting the input file name as the last argument." << std::endl;
+    print_usage( std::cout, argv[0] );
+    return(1);
+  }
+
+  if( !grammar_filename.empty() && (print_ast || !ast_filename.empty() || preparse) ) {
+    std::cout << "Error:  '--grammar' builds no tree and has no top level pass." << std::endl;
     return(1);
   }
 
-  std::string input_filename( argv[1] );
+  std::string input_filename( argv[arg] );
   string_vector program_text;
+  std::string error_message;
+
+  //-----------------------------------------------------------------------------
+  // The counters are sampled at the start and end of each phase.  Without
+  // them the samples stay zero, and nothing is reported.
+  //-----------------------------------------------------------------------------
+
+  PerfCounters counters;
+  PerfSample samples[4] = {};
+
+  if( count_events && !counters.open( error_message ) ) {
+    std::cout << "perf counters unavailable :  " << error_message << std::endl;
+    count_events = false;
+  }
+
+  if( !trace_filename.empty() ) {
+    trace_start( 1 << 16 );
+  }
+
+  samples[0] = counters.read();
 
   //-----------------------------------------------------------------------------
   // Read the input file into a string_vector called program_text.  File open
   // errors will be reported inside the function.
   //-----------------------------------------------------------------------------
     
-  if( !read_file_to_string_vector( input_filename, program_text ) ) {
+  bool loaded = false;
+
+  {
+    TraceSpan span( "load" );
+    loaded = read_file_to_string_vector( input_filename, program_text );
+  }
+
+  if( !loaded ) {
     return(1);
   }
 
+  samples[1] = counters.read();
+
   //-----------------------------------------------------------------------------
   // Instantiate the scanner with the input text and tokenize it. Exit on error.
   //-----------------------------------------------------------------------------
   
   Scanner scanner( program_text );
+  bool tokenized = false;
 
-  std::string error_message;
-  if( !scanner.tokenize(error_message) ) {
+  {
+    TraceSpan span( "tokenize" );
+    tokenized = scanner.tokenize(error_message);
+  }
+
+  if( !tokenized ) {
     if( error_message.length() > 0 ) {
       std::cout << "error :  " << error_message << std::endl;
     }
     return(2);    
   }
 
+  samples[2] = counters.read();
+
+  std::uint64_t bytes = 0;
+
+  for( const std::string & line : program_text ) {
+    bytes += line.length() + 1;
+  }
+
+
+  //-----------------------------------------------------------------------------
+  // With a grammar file, the table driven parser takes the place of Parser.
+  //-----------------------------------------------------------------------------
+
+  if( !grammar_filename.empty() ) {
+
+    Grammar grammar;
+    bool grammar_loaded = false;
+
+    {
+      TraceSpan span( "grammar" );
+      grammar_loaded = grammar.load( grammar_filename, error_message );
+    }
+
+    if( !grammar_loaded ) {
+      std::cout << "Error:  " << error_message << std::endl;
+      return(1);
+    }
+
+    TableParser<> table_parser( grammar );
+    bool pass = false;
+
+    {
+      TraceSpan span( "parse" );
+      pass = table_parser.parse( scanner );
+    }
+
+    samples[3] = counters.read();
+
+    if( pass ) {
+      std::cout << "pass production " << table_parser.get_expansion_count() << std::endl;
+    } else {
+      for( const ParseError & error : table_parser.get_errors() ) {
+	std::cout << "error :  " << error.message << std::endl;
+      }
+    }
+
+    if( count_events ) {
+      print_perf_counters( std::cout, counters, samples, scanner.get_token_count(), bytes );
+    }
+
+    if( report_memory ) {
+      print_memory_report( std::cout, memory_items( program_text, scanner, nullptr, &grammar ), bytes, scanner.get_token_count() );
+    }
+
+    if( !trace_filename.empty() && !trace_write( trace_filename, error_message ) ) {
+      std::cout << "Error:  " << error_message << std::endl;
+      return(1);
+    }
+
+    return(0);
+
+  }
 
   //-----------------------------------------------------------------------------
   // The scanner gets pushed into the parser.  The parser controls the main loop
-  // other the scanner to analyze the text.
+  // other the scanner to analyze the text.  Its listener does the counting.
   //-----------------------------------------------------------------------------
 
   Parser parser;
+  parser.set_max_nesting_depth( max_nesting_depth );
+  parser.set_threads( thread_count );
+
+  Ast ast;
+  bool build_ast = print_ast || !ast_filename.empty();
   
-  bool pass = parser.parse( scanner );
+  bool pass = false;
+
+  if( preparse ) {
+
+    //---------------------------------------------------------------------------
+    // The top level is reported, tree included, while the function bodies are
+    // parsed on a thread of their own.
+    //---------------------------------------------------------------------------
+
+    bool top_level = false;
+
+    {
+      TraceSpan span( "preparse" );
+      top_level = build_ast ? parser.preparse( scanner, ast ) : parser.preparse( scanner );
+    }
+
+    if( top_level ) {
+      std::cout << "top level "
+		<< "variable " << parser.get_listener().get_variable_count() << " "
+		<< "function " << parser.get_listener().get_function_count() << std::endl;
+    }
+
+    std::thread bodies( [&parser, &pass]() {
+	TraceSpan span( "finish" );
+	pass = parser.finish();
+      } );
+
+    if( top_level && print_ast ) {
+      ast.print( std::cout, scanner.get_tokens() );
+    }
+
+    bodies.join();
+
+  } else {
+    TraceSpan span( "parse" );
+    pass = build_ast ? parser.parse( scanner, ast ) : parser.parse( scanner );
+  }
+
+  samples[3] = counters.read();
 
   if( pass ) {
     std::cout << "pass "
-	      << "variable " << parser.get_variable_count() << " "
-	      << "function " << parser.get_function_count() << " "
-	      << "statement " << parser.get_statement_count() << std::endl;
+	      << "variable " << parser.get_listener().get_variable_count() << " "
+	      << "function " << parser.get_listener().get_function_count() << " "
+	      << "statement " << parser.get_listener().get_statement_count() << std::endl;
+    if( print_ast && !preparse ) {
+      ast.print( std::cout, scanner.get_tokens() );
+    }
+    if( !ast_filename.empty() && !write_ast_file( ast_filename, ast, scanner.get_tokens(), error_message ) ) {
+      std::cout << "Error:  " << error_message << std::endl;
+      return(1);
+    }
+  } else if( !parser.get_errors().empty() ) {
+    for( const ParseError & error : parser.get_errors() ) {
+      std::cout << "error :  " << error.message << std::endl;
+    }
   } else {
     std::cout << "error : parser error" << std::endl;
   }
 
-  
-  return(0);
-}
+  if( count_events ) {
+    print_perf_counters( std::cout, counters, samples, scanner.get_token_count(), bytes );
+  }
 
-//-----------------------------------------------------------------------------
-// Open a file stored in the string 'filename' for reading.  Store the
-// result in a string_vector as the program text.  Report I/O failures
-// and return false if one happens.
-//-----------------------------------------------------------------------------
+  if( report_memory ) {
+    print_memory_report( std::cout, memory_items( program_text, scanner, build_ast ? &ast : nullptr, nullptr ),
+			 bytes, scanner.get_token_count() );
+  }
 
-bool read_file_to_string_vector( const std::string & filename,
-				 string_vector & file_text ) {
+  if( !trace_filename.empty() && !trace_write( trace_filename, error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  //-----------------------------------------------------------------------------
+  // The scanner and parser keep their storage from one input to the next, so
+  // once warmed up, by the pass above and one reset, scanning and parsing the
+  // same input again is expected to allocate nothing.  Syntax errors allocate
+  // their messages, and parsing on more than one thread allocates the workers.
+  //-----------------------------------------------------------------------------
+
+  if( count_allocations ) {
+
+    AllocationCount start{0, 0}, scanned{0, 0}, parsed{0, 0};
+
+    for( int repeat = 0; repeat < 2; ++repeat ) {
+
+      start = allocation_count();
+
+      scanner.reset( program_text );
+      scanner.tokenize( error_message );
+
+      scanned = allocation_count();
+
+      parser.reset();
+
+      if( build_ast ) {
+	parser.parse( scanner, ast );
+      } else {
+	parser.parse( scanner );
+      }
+
+      parsed = allocation_count();
 
-  std::fstream input_file;
-  input_file.open( filename, std::ios::in );
-  
-  if( input_file.is_open() ) {
-    
-    std::string line;
-    
-    while( std::getline( input_file, line ) ) {
-      file_text.push_back(line);
     }
-    
-    input_file.close();
 
-    return(true);
-    
-  } else {
+    std::cout << "allocations "
+	      << "scan " << (scanned.allocations - start.allocations) << " "
+	      << "parse " << (parsed.allocations - scanned.allocations) << std::endl;
 
-    std::cout << "Failed to open file '" << filename << "'." << std::endl;
-    return(false);
-    
   }
-    
-}
-
 
+  
+  return(0);
+}
@@ -1,112 +1,537 @@
 #include "parser.h"
 
+#include "ast.h"
 #include "first_plus.h"
+#include "rule_profile.h"
 #include "scanner.h"
 #include "token.h"
+#include "token_source.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 
 //----------------------------------------------------------------------------------------------
 // The Parser object.  Aside from the usual constructor / destructor pair, there is parse(),
-// get_next_word(), 3 getters for the counts, and the rules for the grammer, starting with
+// get_next_word(), the listener getter, and the rules for the grammer, starting with
 // program_start().  For now, the first_plus_sets lives outside this class.  I do this for
 // clarity.  With all of the subroutine calls of the actual grammar, it started to clutter
 // the fail.  Later, after grading and some usage, I plan to refactor into two private impls,
 // one per the first plus table and the other for the recursive routines.
 //
 // Failure is maintained in a global state.  Rather than break out of any recursive calls, I
-// set the fail state and let the stack unwind naturally.  This anticipates the need for
-// error correction / useful parse diagnostics.
+// set the fail state and let the stack unwind naturally.  The loops over statements and
+// declarations, and program_start(), catch the failure, record a ParseError and skip ahead
+// to where the parse can pick up again, see recover().
 //
-// Finally, variable "Token current_word" holds the top of the Token stack.  All routines look
-// to it when making decisions based on tokens.
+// Finally, cursor.current() is the top of the Token stack, a reference into the source's
+// tokens.  All routines look to it when making decisions based on tokens.
+//
+// The counts are no longer kept here.  Every routine tells the listener which production it
+// chose and when it matched, and get_next_word() tells it about each token consumed.  The
+// counting is done by CountListener, see parse_listener.h.
 //----------------------------------------------------------------------------------------------
 
 
-Parser::Parser() :
-  fail_state{false}, variable_count{0}, function_count{0}, statement_count{0},
-  scanner{nullptr},
-  current_word{ TokenType::INITIAL, std::string{""}, 0 }
+template< typename Listener, typename Source >
+BasicParser<Listener, Source>::BasicParser() :
+  fail_state{false}, listener{},
+  source{nullptr}, cursor{},
+  thread_count{0}, defer_bodies{false}, top_level_pass{false}, body_spans{}, deferred_bodies{},
+  continuations{}, max_nesting_depth{0},
+  errors{}, stopped{false}, swallowed_token{Ast::no_token},
+  ast{nullptr}, ast_frames{}, ast_operands{}, ast_operators{},
+  type_token{0}, name_token{0}
 {
 
   //----------------------------------------------------------------------------------------------
   // The first plus sets are statically allocated.  I could have placed them into
   // a giant initializer list and moved the initializtion to a compiler step, but
   // it becomes unreadable without variable assignment syntax on a deep nested
-  // structure.  When the parser is fully vetted, I'll refactor so that this step
-  // is not needed.
+  // structure.  Instead they are built once, on first use, and read only after;
+  // see first_plus_table().  Build them here so that no parse pays for it.
   //----------------------------------------------------------------------------------------------
   
-  if( !first_plus_sets_initialized ) {
+  first_plus_table();
 
-    initialize_first_plus_sets();
-    first_plus_sets_initialized = true;
+}
 
-  }
+template< typename Listener, typename Source >
+BasicParser<Listener, Source>::~BasicParser() {
 }
 
-Parser::~Parser() {
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::reset( void ) {
+
+  fail_state = false;
+  listener = Listener{};
+
+  source = nullptr;
+  cursor = TokenCursor<Source>{};
+
+  top_level_pass = false;
+  body_spans.clear();
+  deferred_bodies.clear();
+
+  continuations.clear();
+  errors.clear();
+  stopped = false;
+  swallowed_token = Ast::no_token;
+
+  ast = nullptr;
+  ast_frames.clear();
+  ast_operands.clear();
+  ast_operators.clear();
+
+  type_token = 0;
+  name_token = 0;
+
 }
 
 //----------------------------------------------------------------------------------------------
-// Use the scanner and internally assign it within the Parse framework.  Now, the parser
+// Use the token source and internally assign it within the Parse framework.  Now, the parser
 // controls the main scan loop.  Descend into 'program_start'.  Return status of the parse.
 //----------------------------------------------------------------------------------------------
 
-bool Parser::parse( Scanner & scanner ) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parse( const Source & source ) {
 
-  this->scanner = &scanner;
+  ast = nullptr;
 
-  
-#ifdef DEBUG
+  return( parse_tokens( source, false ) );
 
-  this->scanner->debug_display_token( current_word );
+}
+
+//----------------------------------------------------------------------------------------------
+// The same, building the tree into 'tree' as the productions are matched.  Anything 'tree'
+// held before is dropped.  The tree is only meaningful when the parse passes.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parse( const Source & source, Ast & tree ) {
+
+  start_tree( tree );
+
+  bool pass = parse_tokens( source, false );
+
+  ast = nullptr;
+
+  return( pass );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Parse the top level only.  Function bodies are brace matched and skipped, not parsed, and
+// finish() parses them later.  A tree built here has an empty block for each body.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::preparse( const Source & source ) {
+
+  ast = nullptr;
+
+  return( parse_tokens( source, true ) );
+
+}
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::preparse( const Source & source, Ast & tree ) {
+
+  start_tree( tree );
+
+  bool pass = parse_tokens( source, true );
+
+  ast = nullptr;
+
+  return( pass );
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::start_tree( Ast & tree ) {
+
+  tree.clear();
+
+  ast_frames.clear();
+  ast_operands.clear();
+  ast_operators.clear();
+
+  ast = &tree;
+  ast_frames.push_back( AstFrame{ tree.add_node( NodeKind::program, Ast::no_token ), Ast::null_node, 0 } );
+
+}
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parse_tokens( const Source & source, bool top_level_only ) {
+
+  this->source = &source;
+  cursor.start( source );
+  fail_state = false;
+
+  continuations.clear();
+  errors.clear();
+  stopped = false;
+  swallowed_token = Ast::no_token;
+
+  if( top_level_only ) {
+    return( parse_top_level() );
+  }
+
+  if( (thread_count > 1) && (ast == nullptr) ) {
+    parse_top_level();
+    return( finish() );
+  }
 
-#endif
-  
   return( program_start() );
 
 }
 
 //----------------------------------------------------------------------------------------------
-// This is a convenience routine which is pretty straightforward.  Any time a new token is
-// needed this routine will fetch it.  It must skip over all meta statements and it must check
-// to see if the stack contains more items.  If no more tokens are on the stack it must signal
-// 'false' in the return call, which will lead to a parse error.
+// One pass over the tokens finds the braces at the top level.  The top level parse then skips
+// each function body it comes to and leaves it in deferred_bodies.
 //----------------------------------------------------------------------------------------------
 
-bool Parser::get_next_word( void ) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parse_top_level( void ) {
 
-  // Skip over meta-statements.
-  
-  while( scanner->has_more_tokens() ) {
-    
-#ifdef DEBUG
+  std::uint32_t count = source->get_token_count();
+  unsigned depth = 0;
+  std::uint32_t open = 0;
 
-  this->scanner->debug_display_token( current_word );
+  body_spans.clear();
+  deferred_bodies.clear();
 
-#endif
-  
-    current_word = scanner->get_next_token();
-    
-    if( current_word.get_token_type() != TokenType::META_STATEMENT ) {
-      
-      return(true);
+  for( std::uint32_t index = 0; index < count; ++index ) {
+
+    const Token & token = source->get_token( index );
+
+    if( token.get_token_type() != TokenType::SYMBOL ) {
+      continue;
+    }
+
+    if( token.get_token_name() == "{" ) {
+      if( depth++ == 0 ) {
+	open = index;
+      }
+    } else if( (token.get_token_name() == "}") && (depth > 0) && (--depth == 0) ) {
+      body_spans.push_back( Body{ open, index } );
+    }
+
+  }
+
+  defer_bodies = true;
+  top_level_pass = program_start();
+  defer_bodies = false;
+
+  return( top_level_pass );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Parse the function bodies the top level parse skipped, on worker threads.  The workers, one
+// parser each, take bodies off the list until it runs out.  The calling thread is one of them.
+// Their listeners and errors are merged into this parser's once all are done, the errors back
+// into input order.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::finish( void ) {
+
+  bool pass = top_level_pass;
+
+  struct Result {
+    Listener                listener;
+    std::vector<ParseError> errors;
+    bool                    pass;
+  };
+
+  std::vector<Result> results( std::min<std::size_t>( std::max( thread_count, 1u ), deferred_bodies.size() ) );
+  std::atomic<std::size_t> next_body{0};
+
+  auto work = [this, &next_body]( Result & result ) {
 
+    BasicParser<Listener, Source> worker;
+    worker.set_max_nesting_depth( max_nesting_depth );
+
+    result.pass = true;
+
+    for( std::size_t body = next_body++; body < deferred_bodies.size(); body = next_body++ ) {
+      result.pass = worker.parse_body( *source, deferred_bodies[body] ) && result.pass;
     }
 
+    result.listener = worker.listener;
+    result.errors = std::move( worker.errors );
+
+  };
+
+  std::vector<std::thread> threads;
+
+  for( std::size_t index = 1; index < results.size(); ++index ) {
+    threads.emplace_back( work, std::ref( results[index] ) );
+  }
+
+  if( !results.empty() ) {
+    work( results[0] );
+  }
+
+  for( std::thread & thread : threads ) {
+    thread.join();
+  }
+
+  for( Result & result : results ) {
+    listener.merge( result.listener );
+    errors.insert( errors.end(), result.errors.begin(), result.errors.end() );
+    pass = pass && result.pass;
+  }
+
+  std::stable_sort( errors.begin(), errors.end(), []( const ParseError & a, const ParseError & b ) {
+      return( a.token < b.token );
+    } );
+
+  deferred_bodies.clear();
+  top_level_pass = pass;
+
+  return( pass && errors.empty() );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Parse the body of a function, from the token after its left_brace through its right_brace,
+// as <func_2> would.  Errors pile up across calls.  func_2() recovers from them within the
+// body at the statement level, as it does in a serial parse, so that the errors of the bodies
+// merged by finish() are those of a serial parse.  Only the end of the input, or a parse
+// stopped by the nesting limit, leaves the body unfinished.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parse_body( const Source & source, const Body & body ) {
+
+  this->source = &source;
+  cursor.start( source );
+
+  continuations.clear();
+  stopped = false;
+  fail_state = false;
+
+  std::size_t reported = errors.size();
+  const Token & name = source.get_token( trace_enabled() ? function_name( source, body.first ) : body.first );
+  TraceSpan span( "function", name.get_token_name(), name.get_line_number() );
+
+  if( !cursor.seek( body.first + 1 ) || !func_2() || (cursor.position() <= body.last) ) {
+    report_error( cursor.position() );
+  }
+
+  return( errors.size() == reported );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// The ID that names the function whose body starts at 'brace', in front of the parameter list,
+// which has no parentheses of its own.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+std::uint32_t BasicParser<Listener, Source>::function_name( const Source & source, std::uint32_t brace ) {
+
+  std::uint32_t index = brace;
+
+  while( (index > 1) && ((source.get_token( index ).get_token_type() != TokenType::SYMBOL) ||
+			 (source.get_token( index ).get_token_name() != "(")) ) {
+    --index;
+  }
+
+  return( (index > 0) ? index - 1 : 0 );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Called with the left_brace of a function body just consumed.  When bodies are left to the
+// workers, skip past the matching right_brace and carry on as if the body had matched.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::defer_body( std::uint32_t brace ) {
+
+  if( !defer_bodies ) {
+    return(false);
   }
 
+  auto span = std::lower_bound( body_spans.begin(), body_spans.end(), brace, []( const Body & body, std::uint32_t first ) {
+      return( body.first < first );
+    } );
+
+  if( (span == body_spans.end()) || (span->first != brace) ) {
+    return(false);
+  }
+
+  deferred_bodies.push_back( *span );
+
+  cursor.seek( span->last + 1 );
+
+  fail_state = false;
+  return(true);
+
+}
+
+//----------------------------------------------------------------------------------------------
+// This is a convenience routine which is pretty straightforward.  Any time a new token is
+// needed this routine will fetch it.  The scanner has left out the meta statements, so that is
+// a step of the cursor.  If no more tokens are on the stack it must signal 'false' in the
+// return call, which will lead to a parse error.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::get_next_word( void ) {
+
+  listener.token( cursor.current() );
+  PROFILE_TOKEN();
+
 #ifdef DEBUG
 
-  std::cout << "ran out of tokens" << std::endl;
-  
+  Scanner::debug_display_token( cursor.current() );
+
 #endif
-  
-  return( false );
+
+  return( cursor.advance() );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Tree building.  These are only called when parse() was handed an Ast.  Statements and
+// declarations are built top down:  ast_open() appends a node to the innermost open node and
+// makes it the new innermost one until ast_close().  Expressions are built bottom up, since an
+// operator is only seen after its left operand.  Finished operands wait on ast_operands and
+// binary operators on ast_operators until an operator of lower or equal precedence, or the end
+// of the (nested) expression, reduces them into 'binary' nodes.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_open( NodeKind kind, std::uint32_t token ) {
+
+  std::uint32_t node = ast->add_node( kind, token );
+
+  ast_append( node );
+  ast_open_nested( node );
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_open_nested( std::uint32_t node ) {
+
+  ast_frames.push_back( AstFrame{ node, Ast::null_node, static_cast<std::uint32_t>( ast_operators.size() ) } );
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_close( void ) {
+
+  ast_frames.pop_back();
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_leaf( NodeKind kind, std::uint32_t token ) {
+
+  ast_append( ast->add_node( kind, token ) );
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_append( std::uint32_t node ) {
+
+  AstFrame & frame = ast_frames.back();
+
+  if( frame.last_child == Ast::null_node ) {
+    (*ast)[frame.node].first_child = node;
+  } else {
+    (*ast)[frame.last_child].next_sibling = node;
+  }
+
+  frame.last_child = node;
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_operand( NodeKind kind, std::uint32_t token ) {
+
+  ast_operands.push_back( ast->add_node( kind, token ) );
+
+}
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_operator( unsigned precedence ) {
+
+  ast_reduce( precedence );
+  ast_operators.push_back( AstOperator{ cursor.position(), precedence } );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Combine pending operators of at least 'min_precedence', innermost first, with the two
+// operands before them.  Operators below the innermost open node's mark belong to an
+// enclosing expression and are left alone.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_reduce( unsigned min_precedence ) {
+
+  std::size_t mark = ast_frames.back().operators;
+
+  while( (ast_operators.size() > mark) && (ast_operators.back().precedence >= min_precedence) ) {
+
+    std::uint32_t right = ast_operands.back();
+    ast_operands.pop_back();
+    std::uint32_t left = ast_operands.back();
+
+    std::uint32_t node = ast->add_node( NodeKind::binary, ast_operators.back().token );
+    ast_operators.pop_back();
+
+    (*ast)[node].first_child = left;
+    (*ast)[left].next_sibling = right;
+
+    ast_operands.back() = node;
+
+  }
+
+}
+
+template< typename Listener, typename Source >
+std::uint32_t BasicParser<Listener, Source>::ast_expression_result( void ) {
+
+  ast_reduce( 0 );
+
+  std::uint32_t node = ast_operands.back();
+  ast_operands.pop_back();
+
+  return( node );
+
+}
+
+//----------------------------------------------------------------------------------------------
+// A nested expression was closed.  A parenthesis leaves no node of its own, just the value of
+// the expression inside.  An index or call becomes an operand of the enclosing expression.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::ast_close_nested( void ) {
+
+  std::uint32_t node = ast_frames.back().node;
+
+  if( node == Ast::null_node ) {
+    node = ast_expression_result();
+  }
+
+  ast_frames.pop_back();
+  ast_operands.push_back( node );
 
 }
 
@@ -124,7 +549,7 @@ bool Parser::get_next_word( void ) {
 //
 // bool A( void ) {
 //
-//   if( check_first_plus_set( current_word, FirstPlus::A_p0 ) ) { // Examine table to see to go down RHS.
+//   if( check_first_plus_set( cursor.current(), FirstPlus::A_p0 ) ) { // Examine table to see to go down RHS.
 //   
 //                     //------------------------------------------------------------
 //     if( B() ) {     // Match to the first production, call non-terminal B().
@@ -134,7 +559,7 @@ bool Parser::get_next_word( void ) {
 //       // See if the current token on the stack matches csymbol.
 //       //------------------------------------------------------------
 //       
-//       if( (current_word.get_token_type() == SYMBOL) && (current_word.get_token_name() == 'csymbol') ) {
+//       if( (cursor.current().get_token_type() == SYMBOL) && (cursor.current().get_token_name() == 'csymbol') ) {
 //       
 //          //------------------------------------------------------------
 //          // Token is used, grab the next.
@@ -164,9 +589,9 @@ bool Parser::get_next_word( void ) {
 //       // The second production just needs to check for terminal 'a'.
 //       //------------------------------------------------------------
 //       
-//    } else if( check_first_plus_set( current_word, FirstPlus::A_p1 ) ) {  // Examine table to see to go down RHS.
+//    } else if( check_first_plus_set( cursor.current(), FirstPlus::A_p1 ) ) {  // Examine table to see to go down RHS.
 // 
-//      if((current_word.get_token_type() == SYMBOL) && (current_word.get_token_name() == 'asymbol')) {
+//      if((cursor.current().get_token_type() == SYMBOL) && (cursor.current().get_token_name() == 'asymbol')) {
 // 
 //       //------------------------------------------------------------
 //       // Fetch the next word.
@@ -182,9 +607,9 @@ bool Parser::get_next_word( void ) {
 // 
 //       }
 // 
-//    } else if( check_first_plus_set( current_word, FirstPlus::A_p2 ) ) {  // Examine table to see to go down RHS.
+//    } else if( check_first_plus_set( cursor.current(), FirstPlus::A_p2 ) ) {  // Examine table to see to go down RHS.
 // 
-//       if((current_word.get_token_type() == SYMBOL) && (current_word.get_token_name() == 'rsymbol')) {
+//       if((cursor.current().get_token_type() == SYMBOL) && (cursor.current().get_token_name() == 'rsymbol')) {
 // 
 //         //------------------------------------------------------------
 //         // The EPSILON case must check to see if the token on the stack is valid.
@@ -211,7 +636,10 @@ bool Parser::get_next_word( void ) {
 //----------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------
 
-bool Parser::program_start( void ) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::program_start( void ) {
+
+  PROFILE_RULE( program_start );
 
   //  <program_start>             --> <program> eof
   //                                | eof
@@ -222,26 +650,50 @@ bool Parser::program_start( void ) {
   
 #endif
   
-  if( get_next_word() ) {
+  if( cursor.seek( 0 ) ) {
 
-    if( check_first_plus_set( current_word, FirstPlus::program_start_p0 ) ) {
- 
-      if( program() ) {
-	if( current_word.get_token_type() == TokenType::EOF_TOK ) {
-	  return(!fail_state);
-	}
-      }
+    if( check_first_plus_set( cursor.current(),  FirstPlus::program_start_p1 ) ) {
 
-    } else if( check_first_plus_set( current_word,  FirstPlus::program_start_p1 ) ) {
-    
-      if( current_word.get_token_type() == TokenType::EOF_TOK ) {
-	
-	return(!fail_state);
-	
+      listener.begin( FirstPlus::program_start_p1 );
+      listener.end( FirstPlus::program_start_p1 );
+
+      return(!fail_state);
+
+    }
+
+    //------------------------------------------------------------
+    // A top level declaration that fails is reported and skipped,
+    // and the parse takes up the next one as a new <program>.
+    // That lets data declarations follow functions again, but the
+    // parse has failed by then anyway.
+    //------------------------------------------------------------
+
+    Checkpoint start = checkpoint();
+
+    listener.begin( FirstPlus::program_start_p0 );
+
+    while( !check_first_plus_set( cursor.current(), FirstPlus::program_start_p0 ) || !program() ||
+	   (cursor.current().get_token_type() != TokenType::EOF_TOK) ) {
+
+      if( !recover( Recovery::program, start ) ) {
+	break;
       }
 
     }
 
+    if( errors.empty() && !fail_state ) {
+      listener.end( FirstPlus::program_start_p0 );
+      return(true);
+    }
+
+    //------------------------------------------------------------
+    // A failure nobody caught was one program_0 swallowed.
+    //------------------------------------------------------------
+
+    if( errors.empty() ) {
+      report_error( (swallowed_token != Ast::no_token) ? swallowed_token : cursor.position() );
+    }
+
   }
 
   fail_state = true;
@@ -250,20 +702,28 @@ bool Parser::program_start( void ) {
   
 }
 
-bool Parser::program(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::program(void) {
+
+  PROFILE_RULE( program );
 
   // <program>                    --> <type_name> ID <program_0>                     FIRST_PLUS = { binary decimal int void }
 
-  if( check_first_plus_set( current_word, FirstPlus::program_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::program_p0 ) ) {
+
+    listener.begin( FirstPlus::program_p0 );
 
     if ( type_name() ) {
 
-      if ( (current_word.get_token_type() == TokenType::IDENTIFIER)  ) {
+      if ( (cursor.current().get_token_type() == TokenType::IDENTIFIER)  ) {
+
+        name_token = cursor.position();
 
         if( get_next_word() ) {
 
           if ( program_0() ) {
 
+            listener.end( FirstPlus::program_p0 );
             return( true );
 
           }
@@ -282,16 +742,25 @@ bool Parser::program(void) {
 
 }
 
-bool Parser::type_name(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::type_name(void) {
+
+  PROFILE_RULE( type_name );
   // <type_name> --> int | void | binary | decimal
 
 
   // Add your code here
-  if (current_word.get_token_type()== TokenType::RESERVED_WORD && (current_word.get_token_name() == "int" ||
-       current_word.get_token_name() == "void" ||
-       current_word.get_token_name() == "binary" ||
-       current_word.get_token_name() == "decimal")) {
+  if (cursor.current().get_token_type()== TokenType::RESERVED_WORD) {
+    FirstPlus production;
+    if (cursor.current().get_token_name() == "int") { production = FirstPlus::type_name_p0; }
+    else if (cursor.current().get_token_name() == "void") { production = FirstPlus::type_name_p1; }
+    else if (cursor.current().get_token_name() == "binary") { production = FirstPlus::type_name_p2; }
+    else if (cursor.current().get_token_name() == "decimal") { production = FirstPlus::type_name_p3; }
+    else { fail_state = true; return false; }
+    listener.begin( production );
+    type_token = cursor.position();
     get_next_word();
+    listener.end( production );
     return true;
   }
   else{ 
@@ -302,27 +771,63 @@ bool Parser::type_name(void) {
 }
 
 // TODO: Implement this function
-bool Parser::program_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::program_0(void) {
+
+  PROFILE_RULE( program_0 );
   // <program_0> --> <id_0> <id_list_0> semicolon <program_1>
   //            | left_parenthesis <func_0> <func_path>
 
   // Add your code here
 
 
+  //------------------------------------------------------------
+  // id_0() takes EPSILON before any token, a left_parenthesis
+  // included, so only the frames the data path opened are
+  // closed, and dropped again when it turns out a function.
+  //------------------------------------------------------------
+
+  std::size_t frames = ast_frames.size();
+  bool opened = false;
+
+  if( check_first_plus_set( cursor.current(), FirstPlus::program_0_p0 ) ) {
+    listener.begin( FirstPlus::program_0_p0 );
+    if( ast ) {
+      ast_open( NodeKind::data_declaration, type_token );
+      ast_open( NodeKind::variable, name_token );
+      opened = true;
+    }
+  }
+
   if (id_0()) {
+    if( opened ) { ast_close(); }
     if (id_list_0()) {
-      if (current_word.get_token_type() ==TokenType::SYMBOL && current_word.get_token_name() == ";") { get_next_word(); 
-        if (program_1())  return true;
+      if (cursor.current().get_token_type() ==TokenType::SYMBOL && cursor.current().get_token_name() == ";") { get_next_word(); 
+        if( opened ) { ast_close(); }
+        if (program_1()) {
+          listener.end( FirstPlus::program_0_p0 );
+          return true;
+        }
       }
     }
   }
 
 
-  if (current_word.get_token_type()== TokenType::SYMBOL && current_word.get_token_name() == "(") {
+  if (cursor.current().get_token_type()== TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
+    if( fail_state && (swallowed_token == Ast::no_token) ) {
+      swallowed_token = cursor.position();
+    }
+    if( ast ) {
+      if( opened ) { ast_frames.resize( frames ); }
+      ast_open( NodeKind::function, name_token );
+      ast_open( NodeKind::parameter_list, cursor.position() );
+    }
+    listener.begin( FirstPlus::program_0_p1 );
     get_next_word();
-    ++function_count;
     if (func_0()) {
+      if( ast ) { ast_close(); }
       if (func_path()) { 
+        listener.end( FirstPlus::program_0_p1 );
         return true;
       }
     }
@@ -337,15 +842,23 @@ bool Parser::program_0(void) {
 
 
 // TODO: Implement this function
-bool Parser::id_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::id_0(void) {
+
+  PROFILE_RULE( id_0 );
   // <id_0> --> left_bracket <expression> right_bracket | EPSILON
 
   // Add your code here 
 
-  if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "[") {
+  if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "[") {
+    listener.begin( FirstPlus::id_0_p0 );
     get_next_word();
     if (!expression()) {fail_state = true; return false;}
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "]") { get_next_word(); return true;}
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "]") {
+      get_next_word();
+      listener.end( FirstPlus::id_0_p0 );
+      return true;
+    }
     fail_state = true;
     return false;
   }
@@ -355,49 +868,80 @@ bool Parser::id_0(void) {
 
 
 // TODO: Implement this function
-bool Parser::id_list_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::id_list_0(void) {
+
+  PROFILE_RULE( id_list_0 );
 
   // <id_list_0>                  --> comma <id> <id_list_0>                     FIRST_PLUS = { comma }
   //                                | EPSILON                     FIRST_PLUS = { EPSILON semicolon }
 
   // Add your code here
   // this will loop through until there's no ',', taking care of the epsilon 
-  while(current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ",") { 
+  while(cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ",") { 
+    listener.begin( FirstPlus::id_list_0_p0 );
     get_next_word();  
-    ++variable_count; 
     if (!id()) {  fail_state = true; return false; }
+    listener.end( FirstPlus::id_list_0_p0 );
   }
   return true;
   
 }
 
 
-bool Parser::program_1(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::program_1(void) {
+
+  PROFILE_RULE( program_1 );
 
   // <program_1>                  --> <type_name> ID <func_or_data>                     FIRST_PLUS = { binary decimal int void }
   //                                | EPSILON                     FIRST_PLUS = { EPSILON eof }
+  //
+  // The data path of <func_or_data> ends by recursing back into <program_1>, once per global
+  // declaration.  That tail call is run as a loop here, and reported as one <program_1> per
+  // declaration.
 
-  if( check_first_plus_set( current_word, FirstPlus::program_1_p0 ) ) {
+  while( check_first_plus_set( cursor.current(), FirstPlus::program_1_p0 ) ) {
 
-    if ( type_name() ) {
+    bool is_function = false;
 
-      if ( (current_word.get_token_type() == TokenType::IDENTIFIER)  ) {
+    listener.begin( FirstPlus::program_1_p0 );
 
-        if( get_next_word() ) {
+    if ( type_name() ) {
 
-          if ( func_or_data() ) {
-            ++function_count;
-            return( true );
+      if ( (cursor.current().get_token_type() == TokenType::IDENTIFIER)  ) {
 
-          }
+        name_token = cursor.position();
 
-        }
+        if( get_next_word() ) {
 
-      }
+          if ( func_or_data( is_function ) ) {
 
-    }
+            listener.end( FirstPlus::program_1_p0 );
 
-  } else if( check_first_plus_set( current_word, FirstPlus::program_1_p1 ) ) {
+            if( is_function ) {
+
+              return( true );
+
+            }
+
+            continue;
+
+          }
+
+        }
+
+      }
+
+    }
+
+    fail_state = true;
+
+    return(false);
+
+  }
+
+  if( check_first_plus_set( cursor.current(), FirstPlus::program_1_p1 ) ) {
 
       // EPSILON consumes no tokens.
 
@@ -412,48 +956,65 @@ bool Parser::program_1(void) {
 }
 
 // TODO: Implement this function
-bool Parser::func_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_0(void) {
+
+  PROFILE_RULE( func_0 );
 
   // <func_0>                     --> <parameter_list> right_parenthesis <func_1>                     FIRST_PLUS = { binary decimal int void }
-  //                                | right_parenthesis <func_4>                     FIRST_PLUS = { right_parenthesis }
+  //                                | right_parenthesis <func_1>                     FIRST_PLUS = { right_parenthesis }
 
   // Add your code here
 
-    if (current_word.get_token_type() == TokenType::RESERVED_WORD && (current_word.get_token_name() == "binary" ||
-       current_word.get_token_name() == "decimal" ||
-       current_word.get_token_name() == "int" ||
-       current_word.get_token_name() == "void")) {
+    if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && (cursor.current().get_token_name() == "binary" ||
+       cursor.current().get_token_name() == "decimal" ||
+       cursor.current().get_token_name() == "int" ||
+       cursor.current().get_token_name() == "void")) {
+    listener.begin( FirstPlus::func_0_p0 );
     if(!parameter_list()) { fail_state = true; return false;}
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
+      if( ast ) { ast_close(); }
       get_next_word(); 
-      return func_1();
+      if (!func_1()) { return false; }
+      listener.end( FirstPlus::func_0_p0 );
+      return true;
     } else {
       fail_state = true;
       return false;
     }
   }
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+  else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
+    listener.begin( FirstPlus::func_0_p1 );
+    if( ast ) { ast_close(); }
     get_next_word();
-    return func_4();
+    if (!func_1()) { return false; }
+    listener.end( FirstPlus::func_0_p1 );
+    return true;
   }
   fail_state =true;
   return false;
 }
 
-bool Parser::func_path(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_path(void) {
+
+  PROFILE_RULE( func_path );
 
   // <func_path>                  --> <func_list>                     FIRST_PLUS = { binary decimal int void }
   //                                | EPSILON                     FIRST_PLUS = { EPSILON eof }
 
-  if( check_first_plus_set( current_word, FirstPlus::func_path_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::func_path_p0 ) ) {
+
+    listener.begin( FirstPlus::func_path_p0 );
 
     if ( func_list() ) {
 
+      listener.end( FirstPlus::func_path_p0 );
       return( true );
 
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::func_path_p1 ) ) {
+  } else if( check_first_plus_set( cursor.current(), FirstPlus::func_path_p1 ) ) {
 
       // EPSILON consumes no tokens.
 
@@ -467,644 +1028,1059 @@ bool Parser::func_path(void) {
 
 }
 
-// TODO: Implement this function
-bool Parser::expression(void) {
+//----------------------------------------------------------------------------------------------
+// Expressions are parsed by precedence climbing instead of the <expression> <term> <factor>
+// cascade of the grammar.  The cascade
+//
+//   <expression>   --> <factor> <term_0> <expression_0>
+//   <term>         --> <factor> <term_0>
+//   <term_0>       --> <mulop> <factor> <term_0> | EPSILON
+//   <expression_0> --> <addop> <term> <expression_0> | EPSILON
+//
+// describes operands separated by + - * /, with * and / binding tighter.  Each operand is
+// matched by a single call to operand().  The language accepted is exactly the one of the
+// grammar:  an expression ends on the first token that is not a binary operator, and that
+// token must be in the EPSILON set of <expression_0>.
+//
+// Nested expressions -- '( <expression> )', 'ID [ <expression> ]' and call arguments -- do
+// not recurse.  Opening one pushes a continuation which says how the nested expression has
+// to be closed, and the loop below carries on with the operand inside it.  Deep nesting
+// therefore costs heap space in 'continuations' rather than machine stack.
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::expression(void) {
+
+  PROFILE_RULE( expression );
 
   // <expression>                 --> <factor> <term_0> <expression_0>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
 
-  // Add your code here
+  std::size_t base = continuations.size();
+  bool expect_operand = false;
 
-   if (factor() && term_0() && expression_0()) return true;
-  
-  fail_state = true;
-  return false;
+  listener.begin( FirstPlus::expression_p0 );
 
-}
+  //------------------------------------------------------------
+  // Fast path:  a lone ID or NUMBER followed directly by a token
+  // that ends the expression, e.g. 'x;' or '1)'.
+  //------------------------------------------------------------
 
-// TODO: Implement this function
-bool Parser::id(void) {
+  TokenType type = cursor.current().get_token_type();
 
-  // <id>                         --> ID <id_0>                     FIRST_PLUS = { ID }
+  if( (type == TokenType::NUMBER) || (type == TokenType::IDENTIFIER) ) {
 
-  // Add your code here
+    FirstPlus factor = (type == TokenType::NUMBER) ? FirstPlus::factor_p1 : FirstPlus::factor_p0;
+    std::uint32_t token = cursor.position();
 
-    if (current_word.get_token_type()== TokenType::IDENTIFIER) {
-    get_next_word(); 
-    return id_0();
-  }
+    listener.begin( factor );
 
+    get_next_word();
 
-  fail_state = true;
-  return false;
+    if( check_first_plus_set( cursor.current(), FirstPlus::expression_0_p1 ) ) {
 
-}
+      if( ast ) { ast_leaf( (type == TokenType::NUMBER) ? NodeKind::number : NodeKind::identifier, token ); }
 
-bool Parser::func_or_data(void) {
+      listener.end( factor );
+      listener.end( FirstPlus::expression_p0 );
 
-  // <func_or_data>               --> <id_0> <id_list_0> semicolon <program_1>                     FIRST_PLUS = { comma left_bracket semicolon }
-  //                                | left_parenthesis <func_0> <func_list_0>                     FIRST_PLUS = { left_parenthesis }
+      return( true );
 
-  if( check_first_plus_set( current_word, FirstPlus::func_or_data_p0 ) ) {
+    }
 
-    if ( id_0() ) {
+    if( type == TokenType::NUMBER ) {
 
-      ++variable_count;
-      
-      if ( id_list_0() ) {
+      if( ast ) { ast_operand( NodeKind::number, token ); }
 
-        if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == ";")  ) {
+      listener.end( FirstPlus::factor_p1 );
 
-          if( get_next_word() ) {
+    } else if( !operand_suffix( token, expect_operand ) ) {
 
-            if ( program_1() ) {
+      fail_state = true;
+      return(false);
 
-              return( true );
+    }
 
-            }
+  } else if( !operand( expect_operand ) ) {
 
-          }
+    fail_state = true;
+    return(false);
 
-        }
+  }
+
+  while( true ) {
+
+    if( expect_operand ) {
+
+      if( !operand( expect_operand ) ) {
+
+        fail_state = true;
+        return(false);
 
       }
 
+      continue;
+
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::func_or_data_p1 ) ) {
+    unsigned precedence = binary_operator_precedence();
 
-    if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == "(")  ) {
-      if( get_next_word() ) {
-        ++function_count;
-        if ( func_0() ) {
+    if( precedence != 0 ) {
 
-          if ( func_list_0() ) {
+      if( ast ) { ast_operator( precedence ); }
 
-            return( true );
+      get_next_word();
+      expect_operand = true;
+      continue;
 
-          }
+    }
 
-        }
+    //------------------------------------------------------------
+    // The innermost open expression ends here.
+    //------------------------------------------------------------
 
-      }
+    if( !check_first_plus_set( cursor.current(), FirstPlus::expression_0_p1 ) ) {
+
+      fail_state = true;
+      return(false);
 
     }
 
-  }
+    if( continuations.size() == base ) {
 
-  fail_state = true;
+      if( ast ) { ast_append( ast_expression_result() ); }
 
-  return(false);
+      listener.end( FirstPlus::expression_p0 );
 
-}
+      return( true );
 
-// TODO: Implement this function
-bool Parser::parameter_list(void) {
+    }
 
-  // <parameter_list>             --> void <parameter_list_0>                     FIRST_PLUS = { void }
-  //                                | int ID <non_empty_list_0>                     FIRST_PLUS = { int }
-  //                                | decimal ID <non_empty_list_0>                     FIRST_PLUS = { decimal }
-  //                                | binary ID <non_empty_list_0>                     FIRST_PLUS = { binary }
+    if( !close_nested_expression( expect_operand ) ) {
 
-  // Add your code here
+      fail_state = true;
+      return(false);
 
-  // take care of void get in 
-  if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "void") {
-    get_next_word(); 
-    return parameter_list_0();
-  }
-  
-  // now take caer of int, decimal, or binary 
-  if (current_word.get_token_type() == TokenType::RESERVED_WORD && (current_word.get_token_name() == "int" ||
-      current_word.get_token_name() == "decimal" || current_word.get_token_name() == "binary")) {
-    if (!type_name()) { fail_state = true; return false;}
+    }
 
-    // once there's a int, decimal, or binary there must be a identifier that follows if not it won't work 
-    if (current_word.get_token_type() != TokenType::IDENTIFIER) { fail_state = true; return false; }
-    get_next_word();  
-    return non_empty_list_0();
   }
-  
-  fail_state = true;
-  return false;
 
 }
 
-// TODO: Implement this function
-bool Parser::func_1(void) {
+//----------------------------------------------------------------------------------------------
+// Returns the binding strength of the binary operator on top of the token stack:  2 for
+// <mulop>, 1 for <addop> and 0 if the token is not a binary operator at all.
+//----------------------------------------------------------------------------------------------
 
-  // <func_1>                     --> semicolon                     FIRST_PLUS = { semicolon }
-  //                                | left_brace <func_2>                     FIRST_PLUS = { left_brace }
+template< typename Listener, typename Source >
+unsigned BasicParser<Listener, Source>::binary_operator_precedence(void) {
 
+  if( cursor.current().get_token_type() != TokenType::SYMBOL ) {
+    return(0);
+  }
 
-  if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
-    get_next_word();  
-    //++function_count;
-    return true;
+  const std::string & name = cursor.current().get_token_name();
 
-    fail_state = false; 
+  if( name.length() != 1 ) {
+    return(0);
   }
 
+  switch( name[0] ) {
+
+  case '*' : { return(2); }
+  case '/' : { return(2); }
+  case '+' : { return(1); }
+  case '-' : { return(1); }
+  default  : { return(0); }
 
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "{") {
-    get_next_word();  
-    return func_2();
   }
 
-  fail_state = true;
-  return false; 
 }
 
-// TODO: Implement this function
-bool Parser::func_4(void) {
+//----------------------------------------------------------------------------------------------
+// Match one operand.  'opened' is set when the operand starts a nested expression, which
+// means the next thing expected is the first operand inside it.  The <factor> of such an
+// operand is ended by close_nested_expression().
+//----------------------------------------------------------------------------------------------
 
-  // <func_4>                     --> semicolon                     FIRST_PLUS = { semicolon }
-  //                                | left_brace <func_5>                     FIRST_PLUS = { left_brace }
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::operand( bool & opened ) {
 
-  // Add your code here
+  PROFILE_RULE( operand );
+
+  // <factor>                     --> ID <factor_0>                     FIRST_PLUS = { ID }
+  //                                | NUMBER                     FIRST_PLUS = { NUMBER }
+  //                                | minus_sign NUMBER                     FIRST_PLUS = { minus_sign }
+  //                                | left_parenthesis <expression> right_parenthesis                     FIRST_PLUS = { left_parenthesis }
+
+  opened = false;
+
+  switch( cursor.current().get_token_type() ) {
+
+  case TokenType::IDENTIFIER : {
+
+    std::uint32_t name = cursor.position();
+
+    listener.begin( FirstPlus::factor_p0 );
+
+    get_next_word();
+    return( operand_suffix( name, opened ) );
 
-  if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
-    get_next_word(); 
-    return true;
-    fail_state = false; 
   }
 
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "{") {
-    get_next_word();  
-    return func_5(); 
+  case TokenType::NUMBER : {
+
+    listener.begin( FirstPlus::factor_p1 );
+
+    if( ast ) { ast_operand( NodeKind::number, cursor.position() ); }
+
+    get_next_word();
+    listener.end( FirstPlus::factor_p1 );
+    return( true );
+
   }
-  
-  fail_state = true;
-  return false;
 
-}
+  case TokenType::SYMBOL : {
 
-// TODO: Implement this function
-bool Parser::func_list(void) {
+    if( cursor.current().get_token_name() == "-" ) {
 
-  // <func_list>                  --> <func> <func_list_0>                     FIRST_PLUS = { binary decimal int void }
+      listener.begin( FirstPlus::factor_p2 );
 
- // Add your code here
+      get_next_word();
+
+      if( cursor.current().get_token_type() == TokenType::NUMBER ) {
+
+        if( ast ) { ast_operand( NodeKind::negative_number, cursor.position() ); }
+
+        get_next_word();
+        listener.end( FirstPlus::factor_p2 );
+        return( true );
+
+      }
+
+    } else if( cursor.current().get_token_name() == "(" ) {
+
+      listener.begin( FirstPlus::factor_p3 );
+
+      get_next_word();
+
+      if( push_continuation( Continuation::parenthesis ) ) {
+
+        if( ast ) { ast_open_nested( Ast::null_node ); }
+
+        listener.begin( FirstPlus::expression_p0 );
+
+        opened = true;
+        return( true );
+
+      }
 
- 
-    if (func()) {
-      //++function_count;
-      return func_list_0();
     }
-  
-  
+
+    break;
+
+  }
+
+  default : { break; }
+
+  }
+
   fail_state = true;
-  return false;
+  return(false);
+
 }
 
-// TODO: Implement this function
-bool Parser::factor(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::operand_suffix( std::uint32_t name_token, bool & opened ) {
 
-  // <factor>                     --> ID <factor_0>                     FIRST_PLUS = { ID }
-  //                                | NUMBER                     FIRST_PLUS = { NUMBER }
-  //                                | minus_sign NUMBER                     FIRST_PLUS = { minus_sign }
-  //                                | left_parenthesis <expression> right_parenthesis                     FIRST_PLUS = { left_parenthesis }
+  PROFILE_RULE( operand_suffix );
 
-  // Add your code here
+  // <factor_0>                   --> left_bracket <expression> right_bracket                     FIRST_PLUS = { left_bracket }
+  //                                | left_parenthesis <factor_1>                     FIRST_PLUS = { left_parenthesis }
+  //                                | EPSILON
+  // <factor_1>                   --> <expr_list> right_parenthesis                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
+  //                                | right_parenthesis                     FIRST_PLUS = { right_parenthesis }
+  //
+  // The EPSILON production is accepted without looking at the token; whatever follows the
+  // operand is checked by expression().  'name_token' is the ID in front of the suffix.
+
+  opened = false;
+
+  if( cursor.current().get_token_type() != TokenType::SYMBOL ) {
+    if( ast ) { ast_operand( NodeKind::identifier, name_token ); }
+    listener.end( FirstPlus::factor_p0 );
+    return( true );
+  }
 
-    if (current_word.get_token_type() == TokenType::IDENTIFIER) { get_next_word();  
-    return factor_0();
+  const std::string & name = cursor.current().get_token_name();
 
+  if( name == "[" ) {
 
+    listener.begin( FirstPlus::factor_0_p0 );
 
-  }
-  else if (current_word.get_token_type() == TokenType::NUMBER) {
-    get_next_word();  
-    return true;
-  }
+    get_next_word();
 
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "-") {
-    get_next_word();  
-    if (current_word.get_token_type() == TokenType::NUMBER) {
-      get_next_word();  
-      return true;
-    }  
+    if( push_continuation( Continuation::index ) ) {
+
+      if( ast ) { ast_open_nested( ast->add_node( NodeKind::index, name_token ) ); }
+
+      listener.begin( FirstPlus::expression_p0 );
+
+      opened = true;
+      return( true );
+
+    }
 
     fail_state = true;
-    return false;
+    return(false);
+
   }
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
-    get_next_word(); 
-    if (expression()) {
 
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+  if( name == "(" ) {
+
+    listener.begin( FirstPlus::factor_0_p1 );
+
+    get_next_word();
+
+    if( check_first_plus_set( cursor.current(), FirstPlus::factor_1_p0 ) ) {
+
+      if( push_continuation( Continuation::arguments ) ) {
+
+        if( ast ) { ast_open_nested( ast->add_node( NodeKind::call, name_token ) ); }
+
+        listener.begin( FirstPlus::factor_1_p0 );
+        listener.begin( FirstPlus::expr_list_p0 );
+        listener.begin( FirstPlus::non_empty_expr_list_p0 );
+        listener.begin( FirstPlus::expression_p0 );
+
+        opened = true;
+        return( true );
 
-        get_next_word();  
-        return true;
       }
-    }
 
+    } else if( (cursor.current().get_token_type() == TokenType::SYMBOL) && (cursor.current().get_token_name() == ")") ) {
+
+      if( ast ) { ast_operand( NodeKind::call, name_token ); }
+
+      listener.begin( FirstPlus::factor_1_p1 );
+      get_next_word();
+      listener.end( FirstPlus::factor_1_p1 );
+      listener.end( FirstPlus::factor_0_p1 );
+      listener.end( FirstPlus::factor_p0 );
+      return( true );
+
+    }
 
     fail_state = true;
-    return false;
+    return(false);
+
   }
 
+  if( ast ) { ast_operand( NodeKind::identifier, name_token ); }
 
-  fail_state = true;
-  return false;
-
+  listener.end( FirstPlus::factor_p0 );
 
+  return( true );
 
 }
 
+//----------------------------------------------------------------------------------------------
+// The nested expression on top of the continuation stack has ended.  Match its closing token
+// and pop it, or, for call arguments, step over the comma to the next argument ('opened').
+//----------------------------------------------------------------------------------------------
+
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::close_nested_expression( bool & opened ) {
+
+  PROFILE_RULE( close_nested_expression );
 
-bool Parser::term_0(void) {
+  // <non_empty_expr_list_0>      --> comma <expression> <non_empty_expr_list_0>                     FIRST_PLUS = { comma }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
 
-  // <term_0>                     --> <mulop> <factor> <term_0>                     FIRST_PLUS = { forward_slash star_sign }
-  //                                | EPSILON                     FIRST_PLUS = { != < <= == > >= EPSILON comma double_and_sign double_or_sign minus_sign plus_sign right_bracket right_parenthesis semicolon }
+  opened = false;
 
-  if( check_first_plus_set( current_word, FirstPlus::term_0_p0 ) ) {
+  if( cursor.current().get_token_type() != TokenType::SYMBOL ) {
 
-    if ( mulop() ) {
+    fail_state = true;
+    return(false);
 
-      if ( factor() ) {
+  }
 
-        if ( term_0() ) {
+  const std::string & name = cursor.current().get_token_name();
 
-          return( true );
+  switch( continuations.back() ) {
 
-        }
+  case Continuation::parenthesis : {
+
+    if( name == ")" ) {
+      listener.end( FirstPlus::expression_p0 );
+      if( ast ) { ast_close_nested(); }
+      get_next_word();
+      continuations.pop_back();
+      listener.end( FirstPlus::factor_p3 );
+      return( true );
+    }
+
+    break;
+
+  }
 
+  case Continuation::index : {
+
+    if( name == "]" ) {
+      listener.end( FirstPlus::expression_p0 );
+      if( ast ) {
+        ast_append( ast_expression_result() );
+        ast_close_nested();
       }
+      get_next_word();
+      continuations.pop_back();
+      listener.end( FirstPlus::factor_0_p0 );
+      listener.end( FirstPlus::factor_p0 );
+      return( true );
+    }
+
+    break;
+
+  }
+
+  case Continuation::arguments :
+  case Continuation::more_arguments : {
 
+    if( name == "," ) {
+      listener.end( FirstPlus::expression_p0 );
+      if( continuations.back() == Continuation::more_arguments ) {
+        listener.end( FirstPlus::non_empty_expr_list_0_p0 );
+      }
+      continuations.back() = Continuation::more_arguments;
+      if( ast ) { ast_append( ast_expression_result() ); }
+      listener.begin( FirstPlus::non_empty_expr_list_0_p0 );
+      get_next_word();
+      listener.begin( FirstPlus::expression_p0 );
+      opened = true;
+      return( true );
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::term_0_p1 ) ) {
+    if( name == ")" ) {
+      listener.end( FirstPlus::expression_p0 );
+      if( continuations.back() == Continuation::more_arguments ) {
+        listener.end( FirstPlus::non_empty_expr_list_0_p0 );
+      }
+      listener.end( FirstPlus::non_empty_expr_list_p0 );
+      listener.end( FirstPlus::expr_list_p0 );
+      if( ast ) {
+        ast_append( ast_expression_result() );
+        ast_close_nested();
+      }
+      get_next_word();
+      continuations.pop_back();
+      listener.end( FirstPlus::factor_1_p0 );
+      listener.end( FirstPlus::factor_0_p1 );
+      listener.end( FirstPlus::factor_p0 );
+      return( true );
+    }
 
-      // EPSILON consumes no tokens.
+    break;
 
-    return( true );
+  }
+
+  default : { break; }
 
   }
 
   fail_state = true;
-
   return(false);
 
 }
 
+//----------------------------------------------------------------------------------------------
+// Open a nested block or expression.  This is the single place the nesting limit is enforced,
+// so an adversarial input fails with a message instead of exhausting memory.
+//----------------------------------------------------------------------------------------------
 
-bool Parser::expression_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::push_continuation( Continuation continuation ) {
 
-  // <expression_0>               --> <addop> <term> <expression_0>                     FIRST_PLUS = { minus_sign plus_sign }
-  //                                | EPSILON                     FIRST_PLUS = { != < <= == > >= EPSILON comma double_and_sign double_or_sign right_bracket right_parenthesis semicolon }
+  if( (max_nesting_depth != 0) && (continuations.size() >= max_nesting_depth) ) {
 
-  if( check_first_plus_set( current_word, FirstPlus::expression_0_p0 ) ) {
+    if( !stopped ) {
+      errors.push_back( ParseError{ cursor.position(), cursor.current().get_line_number(),
+	    "Nesting deeper than " + std::to_string( max_nesting_depth ) +
+	    " levels on line " + std::to_string( cursor.current().get_line_number() ) + "." } );
+      stopped = true;
+    }
 
-    if ( addop() ) {
+    fail_state = true;
+    return(false);
 
-      if ( term() ) {
+  }
 
-        if ( expression_0() ) {
+  continuations.push_back( continuation );
 
-          return( true );
+  return( true );
 
-        }
+}
 
-      }
+template< typename Listener, typename Source >
+typename BasicParser<Listener, Source>::Checkpoint BasicParser<Listener, Source>::checkpoint( void ) {
 
-    }
+  return( Checkpoint{ continuations.size(), ast_frames.size(), ast_operands.size(), ast_operators.size() } );
 
-  } else if( check_first_plus_set( current_word, FirstPlus::expression_0_p1 ) ) {
+}
 
-      // EPSILON consumes no tokens.
+//----------------------------------------------------------------------------------------------
+// Record an error at 'token'.  Once a failure is caught every routine it unwinds through has
+// given up at the same token, so a second error there is the same one and is dropped.
+//----------------------------------------------------------------------------------------------
 
-    return( true );
+template< typename Listener, typename Source >
+void BasicParser<Listener, Source>::report_error( std::uint32_t token ) {
 
+  if( stopped || (!errors.empty() && (errors.back().token == token)) ) {
+    return;
   }
 
-  fail_state = true;
+  const Token & word = source->get_token( token );
 
-  return(false);
+  if( word.get_token_type() == TokenType::EOF_TOK ) {
+
+    unsigned line = word.get_line_number();
+
+    errors.push_back( ParseError{ token, line, "Unexpected end of file after line " + std::to_string( line ) + "." } );
+
+  } else {
+
+    errors.push_back( ParseError{ token, word.get_line_number(),
+	  "Unexpected '" + word.get_token_name() + "' on line " + std::to_string( word.get_line_number() ) + "." } );
+
+  }
 
 }
 
+//----------------------------------------------------------------------------------------------
+// Panic mode.  Report the failure at cursor.current(), drop whatever was opened since 'point' and
+// skip tokens, unmatched and so unreported to the listener, up to one the parse can go on
+// from.  The synchronizing sets come from the FOLLOW sets, which are in the FIRST+ sets of the
+// EPSILON productions:
+//
+//   statement  FOLLOW(<data_decls>), the type names of <data_decls_0> and what follows it
+//              in <data_decls_0>'s EPSILON production.  A semicolon ends the statement
+//              skipped and is skipped as well, as is a right_brace closing a block that
+//              the skipping entered.  ID is left out, it is in nearly every expression.
+//              A type name only counts outside of if and while blocks, and followed by
+//              an ID, as the start of a declaration.
+//   program    the type names that start a top level declaration.
+//
+// Braces opened while skipping are skipped up to their match.  Every failing statement and
+// declaration has consumed at least the token it started with, so the parse always moves on.
+// Return false if it cannot go on:  the input has ended or the parse is stopped.
+//----------------------------------------------------------------------------------------------
 
-bool Parser::func_list_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::declaration_follows( void ) {
 
-  // <func_list_0>                --> <func_list>                     FIRST_PLUS = { binary decimal int void }
-  //                                | EPSILON                     FIRST_PLUS = { EPSILON eof }
+  return( cursor.peek( 1 ).get_token_type() == TokenType::IDENTIFIER );
 
-  if( check_first_plus_set( current_word, FirstPlus::func_list_0_p0 ) ) {
+}
 
-    if ( func_list() ) {
-      //++function_count; 
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::recover( Recovery level, const Checkpoint & point ) {
 
-      return( true );
+  report_error( cursor.position() );
+
+  if( stopped ) {
+    return(false);
+  }
+
+  continuations.resize( point.continuations );
+  ast_frames.resize( point.ast_frames );
+  ast_operands.resize( point.ast_operands );
+  ast_operators.resize( point.ast_operators );
+
+  unsigned depth = 0;
+
+  while( cursor.current().get_token_type() != TokenType::EOF_TOK ) {
+
+    bool symbol = (cursor.current().get_token_type() == TokenType::SYMBOL);
+
+    if( depth == 0 ) {
+
+      if( check_first_plus_set( cursor.current(), FirstPlus::data_decls_0_p0 ) &&
+	  ((level == Recovery::program) || ((point.continuations == 0) && declaration_follows())) ) {
+	break;
+      }
+
+      if( level == Recovery::statement ) {
+
+	if( (cursor.current().get_token_type() == TokenType::RESERVED_WORD) &&
+	    check_first_plus_set( cursor.current(), FirstPlus::data_decls_0_p1 ) ) {
+	  break;
+	}
+
+	if( symbol && (cursor.current().get_token_name() == "}") ) {
+	  break;
+	}
+
+	if( symbol && (cursor.current().get_token_name() == ";") ) {
+	  cursor.advance();
+	  break;
+	}
+
+      }
 
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::func_list_0_p1 ) ) {
+    if( symbol && (cursor.current().get_token_name() == "{") ) {
 
-      // EPSILON consumes no tokens.
+      ++depth;
 
-    return( true );
+    } else if( symbol && (cursor.current().get_token_name() == "}") && (depth > 0) ) {
 
-  }
+      if( (--depth == 0) && (level == Recovery::statement) ) {
+	cursor.advance();
+	break;
+      }
 
-  fail_state = true;
+    }
 
-  return(false);
+    cursor.advance();
+
+  }
+
+  return( cursor.current().get_token_type() != TokenType::EOF_TOK );
 
 }
 
 // TODO: Implement this function
-bool Parser::parameter_list_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::id(void) {
 
-  // <parameter_list_0>           --> ID <non_empty_list_0>                     FIRST_PLUS = { ID }
-  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
+  PROFILE_RULE( id );
+
+  // <id>                         --> ID <id_0>                     FIRST_PLUS = { ID }
 
   // Add your code here
 
-    if (current_word.get_token_type() == TokenType::IDENTIFIER) {
+    if (cursor.current().get_token_type()== TokenType::IDENTIFIER) {
+    listener.begin( FirstPlus::id_p0 );
+    if( ast ) { ast_open( NodeKind::variable, cursor.position() ); }
     get_next_word(); 
-    return non_empty_list_0();
-  }; 
- 
-  return true;
+    bool matched = id_0();
+    if( ast ) { ast_close(); }
+    if( matched ) { listener.end( FirstPlus::id_p0 ); }
+    return matched;
+  }
+
+
+  fail_state = true;
+  return false;
+
 }
 
-// TODO: Implement this function
-bool Parser::non_empty_list_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_or_data( bool & is_function ) {
 
-  // <non_empty_list_0>           --> comma <type_name> ID <non_empty_list_0>                     FIRST_PLUS = { comma }
-  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
+  PROFILE_RULE( func_or_data );
 
-  // Add your code here
+  // <func_or_data>               --> <id_0> <id_list_0> semicolon <program_1>                     FIRST_PLUS = { comma left_bracket semicolon }
+  //                                | left_parenthesis <func_0> <func_path>                     FIRST_PLUS = { left_parenthesis }
+  //
+  // The trailing <program_1> of the data path is left to the loop in program_1(), which
+  // looks at is_function to know whether another declaration may follow.
 
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ",") {
-    get_next_word();  
-    if ( !type_name() ) {fail_state = true; return false; }; 
-    if (current_word.get_token_type() != TokenType::IDENTIFIER) { fail_state = true; return false; }; 
-    get_next_word(); 
-    return non_empty_list_0();
-  }; 
-  return true;
-}
+  if( check_first_plus_set( cursor.current(), FirstPlus::func_or_data_p0 ) ) {
 
-// TODO: Implement this function
-bool Parser::func_2(void) {
+    listener.begin( FirstPlus::func_or_data_p0 );
 
-  // <func_2>                     --> <data_decls> <func_3>                     FIRST_PLUS = { binary decimal int void }
-  //                                | <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
-  //                                | right_brace                     FIRST_PLUS = { right_brace }
+    if( ast ) {
+      ast_open( NodeKind::data_declaration, type_token );
+      ast_open( NodeKind::variable, name_token );
+    }
 
-  // Add your code here
+    if ( id_0() ) {
 
-  if (check_first_plus_set(current_word,FirstPlus::data_decls_p0)) {if (data_decls()) return func_3(); } 
-  
-  else if (check_first_plus_set(current_word, FirstPlus::statements_p0)) {
-    if (statements()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-        get_next_word();  
-        return true;
-      }; 
-    }; 
-   }
-    else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-    get_next_word(); 
-    return true;
-  }
+      if( ast ) { ast_close(); }
+
+      if ( id_list_0() ) {
 
+        if ( (cursor.current().get_token_type() == TokenType::SYMBOL) && (cursor.current().get_token_name() == ";")  ) {
 
+          if( ast ) { ast_close(); }
+
+          if( get_next_word() ) {
+
+            listener.end( FirstPlus::func_or_data_p0 );
+            is_function = false;
+            return( true );
+
+          }
+
+        }
+
+      }
+
+    }
+
+  } else if( check_first_plus_set( cursor.current(), FirstPlus::func_or_data_p1 ) ) {
+
+    if ( (cursor.current().get_token_type() == TokenType::SYMBOL) && (cursor.current().get_token_name() == "(")  ) {
+      listener.begin( FirstPlus::func_or_data_p1 );
+      if( ast ) {
+        ast_open( NodeKind::function, name_token );
+        ast_open( NodeKind::parameter_list, cursor.position() );
+      }
+      if( get_next_word() ) {
+        if ( func_0() ) {
+
+          if( ast ) { ast_close(); }
+
+          if ( func_path() ) {
+
+            listener.end( FirstPlus::func_or_data_p1 );
+            is_function = true;
+            return( true );
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
 
   fail_state = true;
-  return false;  
+
+  return(false);
+
 }
 
 // TODO: Implement this function
-bool Parser::func_5(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parameter_list(void) {
 
-  // <func_5>                     --> <data_decls> <func_6>                     FIRST_PLUS = { binary decimal int void }
-  //                                | <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
-  //                                | right_brace                     FIRST_PLUS = { right_brace }
+  PROFILE_RULE( parameter_list );
+
+  // <parameter_list>             --> void <parameter_list_0>                     FIRST_PLUS = { void }
+  //                                | int ID <non_empty_list_0>                     FIRST_PLUS = { int }
+  //                                | decimal ID <non_empty_list_0>                     FIRST_PLUS = { decimal }
+  //                                | binary ID <non_empty_list_0>                     FIRST_PLUS = { binary }
 
   // Add your code here
 
+  // take care of void get in 
+  if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "void") {
+    listener.begin( FirstPlus::parameter_list_p0 );
+    get_next_word(); 
+    if (!parameter_list_0()) { return false; }
+    listener.end( FirstPlus::parameter_list_p0 );
+    return true;
+  }
+  
+  // now take caer of int, decimal, or binary 
+  if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && (cursor.current().get_token_name() == "int" ||
+      cursor.current().get_token_name() == "decimal" || cursor.current().get_token_name() == "binary")) {
+    FirstPlus production = (cursor.current().get_token_name() == "int") ? FirstPlus::parameter_list_p1 :
+      (cursor.current().get_token_name() == "decimal") ? FirstPlus::parameter_list_p2 : FirstPlus::parameter_list_p3;
+    listener.begin( production );
 
-  // same thing as the last just with 
+    // The keyword is matched as a <type_name>, which is reported as well.
+    if (!type_name()) { fail_state = true; return false;}
 
-  if (check_first_plus_set(current_word, FirstPlus::data_decls_p0)) { if (data_decls()) return func_6();
-  } 
-  else if (check_first_plus_set(current_word, FirstPlus::statements_p0)) {
-    if (statements()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-        get_next_word();  
-        return true;
-      }; 
-    }; 
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
+    // once there's a int, decimal, or binary there must be a identifier that follows if not it won't work 
+    if (cursor.current().get_token_type() != TokenType::IDENTIFIER) { fail_state = true; return false; }
+    if( ast ) { ast_leaf( NodeKind::parameter, cursor.position() ); }
     get_next_word();  
+    if (!non_empty_list_0()) { return false; }
+    listener.end( production );
     return true;
   }
-
+  
   fail_state = true;
   return false;
 
 }
 
 // TODO: Implement this function
-bool Parser::func(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_1(void) {
 
-  // <func>                       --> <type_name> ID left_parenthesis <func_0>                     FIRST_PLUS = { binary decimal int void }
+  PROFILE_RULE( func_1 );
 
-  // Add your code here
-  if (type_name()) {
-    if (current_word.get_token_type() == TokenType::IDENTIFIER) {
-      get_next_word();  
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
-        get_next_word();
-        ++function_count; 
-        return func_0();
-      }; 
-    }; 
-  }
+  // <func_1>                     --> semicolon                     FIRST_PLUS = { semicolon }
+  //                                | left_brace <func_2>                     FIRST_PLUS = { left_brace }
 
-  fail_state = true;
-  return false;
 
-}
+  if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
+    listener.begin( FirstPlus::func_1_p0 );
+    get_next_word();  
+    listener.end( FirstPlus::func_1_p0 );
+    return true;
 
+    fail_state = false; 
+  }
 
-bool Parser::factor_1(void) {
-  // <factor_1> --> <expr_list> right_parenthesis                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
-  //               | right_parenthesis                     FIRST_PLUS = { right_parenthesis }
 
-  if (check_first_plus_set(current_word, FirstPlus::factor_1_p0)) {
-    // Try first production: <expr_list> right_parenthesis
-    if (expr_list()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
-        get_next_word();
-        return true;
-      }
-      fail_state = true;
-      return false;
-    }
-    fail_state = true;
-    return false;
-  } 
-  else if (check_first_plus_set(current_word, FirstPlus::factor_1_p1)) {
-    // Try second production: right_parenthesis
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
-      get_next_word();
-      return true;
+  else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "{") {
+    listener.begin( FirstPlus::func_1_p1 );
+    if( ast ) { ast_open( NodeKind::block, cursor.position() ); }
+    std::uint32_t brace = cursor.position();
+    get_next_word();  
+    bool body = defer_body( brace );
+    if( !body ) {
+      const Token & name = source->get_token( name_token );
+      TraceSpan span( "function", name.get_token_name(), name.get_line_number() );
+      body = func_2();
     }
-    fail_state = true;
-    return false;
+    if( ast ) { ast_close(); }
+    if( body ) { listener.end( FirstPlus::func_1_p1 ); }
+    return body;
   }
 
   fail_state = true;
-  return false;
+  return false; 
 }
 
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_list(void) {
 
-// TODO: Implement this function
-bool Parser::factor_0(void) {
+  PROFILE_RULE( func_list );
 
-  // <factor_0>                   --> left_bracket <expression> right_bracket                     FIRST_PLUS = { left_bracket }
-  //                                | left_parenthesis <factor_1>                     FIRST_PLUS = { left_parenthesis }
-  //                                | EPSILON                     FIRST_PLUS = { != < <= == > >= EPSILON comma double_and_sign double_or_sign forward_slash minus_sign plus_sign right_bracket right_parenthesis semicolon star_sign }
+  // <func_list>                  --> <func> <func_path>                     FIRST_PLUS = { binary decimal int void }
+  // <func_path>                  --> <func_list>                     FIRST_PLUS = { binary decimal int void }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON eof }
+  //
+  // One <func> per iteration instead of one stack frame per function in the file, each
+  // reported as a <func_list> of its own.
 
-  // Add your code here
+  do {
+
+    listener.begin( FirstPlus::func_list_p0 );
+
+    if ( !func() ) {
+
+      fail_state = true;
+      return(false);
 
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "[") {
-    get_next_word();  
-    if (!expression()) {
-    fail_state = true;
-      return false;
-    }
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "]") {
-      get_next_word(); 
-      return true;
     }
-    fail_state = true;
-    return false;
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
-    get_next_word();  
-    return factor_1();
+
+    listener.end( FirstPlus::func_list_p0 );
+
+  } while( check_first_plus_set( cursor.current(), FirstPlus::func_path_p0 ) );
+
+  if( check_first_plus_set( cursor.current(), FirstPlus::func_path_p1 ) ) {
+
+      // EPSILON consumes no tokens.
+
+    return( true );
+
   }
 
+  fail_state = true;
 
-   fail_state = false; 
-   return true;
-  
+  return(false);
 
 }
 
 // TODO: Implement this function
-bool Parser::mulop(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::parameter_list_0(void) {
 
-  // <mulop>                      --> star_sign                     FIRST_PLUS = { star_sign }
-  //                                | forward_slash                     FIRST_PLUS = { forward_slash }
+  PROFILE_RULE( parameter_list_0 );
+
+  // <parameter_list_0>           --> ID <non_empty_list_0>                     FIRST_PLUS = { ID }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
 
   // Add your code here
 
-   if (current_word.get_token_type()  == TokenType::SYMBOL) {
-    if (current_word.get_token_name() == "*" || current_word.get_token_name() == "/") {
-      get_next_word();  
-      fail_state = false;
-      return true;
-       
-    }
-  }
+    if (cursor.current().get_token_type() == TokenType::IDENTIFIER) {
+    listener.begin( FirstPlus::parameter_list_0_p0 );
+    if( ast ) { ast_leaf( NodeKind::parameter, cursor.position() ); }
+    get_next_word(); 
+    if (!non_empty_list_0()) { return false; }
+    listener.end( FirstPlus::parameter_list_0_p0 );
+    return true;
+  }; 
+ 
+  return true;
+}
 
-  fail_state = true;
-  return false;
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::non_empty_list_0(void) {
 
+  PROFILE_RULE( non_empty_list_0 );
+
+  // <non_empty_list_0>           --> comma <type_name> ID <non_empty_list_0>                     FIRST_PLUS = { comma }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
+  //
+  // One parameter per pass of the loop; the EPSILON production ends it.
+
+  while (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ",") {
+    listener.begin( FirstPlus::non_empty_list_0_p0 );
+    get_next_word();  
+    if ( !type_name() ) {fail_state = true; return false; }; 
+    if (cursor.current().get_token_type() != TokenType::IDENTIFIER) { fail_state = true; return false; }; 
+    if( ast ) { ast_leaf( NodeKind::parameter, cursor.position() ); }
+    get_next_word(); 
+    listener.end( FirstPlus::non_empty_list_0_p0 );
+  }
+  return true;
 }
 
 // TODO: Implement this function
-bool Parser::addop(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_2(void) {
 
-  // <addop>                      --> plus_sign                     FIRST_PLUS = { plus_sign }
-  //                                | minus_sign                     FIRST_PLUS = { minus_sign }
+  PROFILE_RULE( func_2 );
 
-  // Add your code here
+  // <func_2>                     --> <data_decls> <func_3>                     FIRST_PLUS = { binary decimal int void }
+  //                                | <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
+  //                                | right_brace                     FIRST_PLUS = { right_brace }
 
-    if (current_word.get_token_type() == TokenType::SYMBOL) {
-      if (current_word.get_token_name()== "+" || current_word.get_token_name()== "-") {
-      get_next_word(); 
-      fail_state = false;
+  // Add your code here
+  //
+  // Whatever does not start a declaration and is not the right_brace is taken for statements,
+  // so that a token no statement starts with is reported and skipped by statements() rather
+  // than failing the body, which would leave the rest of it to the top level.
+
+  if (check_first_plus_set(cursor.current(),FirstPlus::data_decls_p0)) {
+    listener.begin( FirstPlus::func_2_p0 );
+    if (data_decls() && func_3()) {
+      listener.end( FirstPlus::func_2_p0 );
       return true;
-       
     }
+    return false;
+  } 
+  
+  else if ((cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != "}")) {
+    listener.begin( FirstPlus::func_2_p1 );
+    if (statements()) {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "}") {
+        get_next_word();  
+        listener.end( FirstPlus::func_2_p1 );
+        return true;
+      }; 
+    }; 
+   }
+    else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "}") {
+    listener.begin( FirstPlus::func_2_p2 );
+    get_next_word(); 
+    listener.end( FirstPlus::func_2_p2 );
+    return true;
   }
 
+
+
   fail_state = true;
-  return false;
+  return false;  
 }
 
 // TODO: Implement this function
-bool Parser::term(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func(void) {
+
+  PROFILE_RULE( func );
 
-  // <term>                       --> <factor> <term_0>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
+  // <func>                       --> <type_name> ID left_parenthesis <func_0>                     FIRST_PLUS = { binary decimal int void }
 
   // Add your code here
+  listener.begin( FirstPlus::func_p0 );
+  if (type_name()) {
+    if (cursor.current().get_token_type() == TokenType::IDENTIFIER) {
+      name_token = cursor.position();
+      get_next_word();  
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
+        if( ast ) {
+          ast_open( NodeKind::function, name_token );
+          ast_open( NodeKind::parameter_list, cursor.position() );
+        }
+        get_next_word();
+        bool matched = func_0();
+        if( ast ) { ast_close(); }
+        if( matched ) { listener.end( FirstPlus::func_p0 ); }
+        return matched;
+      }; 
+    }; 
+  }
 
-  if(factor()) return term_0(); 
+  fail_state = true;
+  return false;
 
-  fail_state = true; 
-  return false; 
 }
 
-bool Parser::data_decls(void) {
-
-  // <data_decls>                 --> <type_name> <id_list> semicolon <data_decls_0>                     FIRST_PLUS = { binary decimal int void }
-
-  if( check_first_plus_set( current_word, FirstPlus::data_decls_p0 ) ) {
-
-    if ( type_name() ) {
 
-      if ( id_list() ) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::data_decls(void) {
 
-        if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == ";")  ) {
+  PROFILE_RULE( data_decls );
 
-          if( get_next_word() ) {
+  // <data_decls>                 --> <type_name> <id_list> semicolon <data_decls_0>                     FIRST_PLUS = { binary decimal int void }
+  // <data_decls_0>               --> <data_decls>                     FIRST_PLUS = { binary decimal int void }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON ID break continue if print read return right_brace while write }
+  //
+  // <data_decls_0> only recurses back into <data_decls>, so the pair is one loop with a
+  // declaration per pass, each reported as a <data_decls> of its own.
 
-            if ( data_decls_0() ) {
+  do {
 
-              return( true );
+    Checkpoint point = checkpoint();
 
-            }
+    if( ast ) { ast_open( NodeKind::data_declaration, cursor.position() ); }
 
-          }
+    listener.begin( FirstPlus::data_decls_p0 );
 
-        }
+    if ( !check_first_plus_set( cursor.current(), FirstPlus::data_decls_p0 ) ||
+         !type_name() || !id_list() ||
+         (cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != ";") ||
+         !get_next_word() ) {
 
+      if( !recover( Recovery::statement, point ) ) {
+        fail_state = true;
+        return(false);
       }
 
+      continue;
+
     }
 
-  }
+    listener.end( FirstPlus::data_decls_p0 );
 
-  fail_state = true;
+    if( ast ) { ast_close(); }
 
-  return(false);
+  } while( check_first_plus_set( cursor.current(), FirstPlus::data_decls_0_p0 ) );
+
+  fail_state = false;
+  return( true );
 
 }
 
 // TODO: Implement this function
-bool Parser::func_3(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::func_3(void) {
+
+  PROFILE_RULE( func_3 );
 
   // <func_3>                     --> <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
   //                                | right_brace                     FIRST_PLUS = { right_brace }
 
   // Add your code here
+  //
+  // As in func_2(), whatever is not the right_brace is taken for statements.
 
-    if (check_first_plus_set(current_word, FirstPlus::statements_p0)) {
+    if ((cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != "}")) {
+    listener.begin( FirstPlus::func_3_p0 );
     if (statements()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "}") {
         get_next_word(); 
+        listener.end( FirstPlus::func_3_p0 );
         fail_state = false;
         return true;
       }
     }
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
+  } else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "}") {
+    listener.begin( FirstPlus::func_3_p1 );
     get_next_word(); 
+    listener.end( FirstPlus::func_3_p1 );
     fail_state = false;
     return true;
   }
@@ -1116,61 +2092,120 @@ bool Parser::func_3(void) {
 
 }
 
-// TODO: Implement this function
-bool Parser::statements(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::statements(void) {
+
+  PROFILE_RULE( statements );
 
   // <statements>                 --> <statement> <statements_0>                     FIRST_PLUS = { ID break continue if print read return while write }
+  // <statements_0>               --> <statements>                     FIRST_PLUS = { ID break continue if print read return while write }
+  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_brace }
+  // <func_3>                     --> <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
+  //                                | right_brace                     FIRST_PLUS = { right_brace }
+  //
+  // <statements_0> only recurses back into <statements>, so the pair is one loop with a
+  // statement per pass.  Stack depth no longer grows with the length of a function body.
+  //
+  // The body of an if or while is not parsed recursively either.  block_statements() leaves
+  // a continuation on the stack and this loop carries on with the statements inside it.
+  // When those run out, the right_brace of <func_3> closes the innermost block
+  // and the statements around it continue.
+  //
+  // Each statement is reported as a <statements> of its own.  One that opened a block only
+  // ends, together with the if or while and the block, when the block is closed.
+  //
+  // The loop ends at the right_brace that closes the body, and only there.  A declaration
+  // among the statements is reported and parsed as one.  Anything else that does not start a
+  // statement is reported and skipped at the statement level, so a body is recovered within
+  // its own braces, the same whether it is parsed with the top level or by parse_body().
+
+  std::size_t base = continuations.size();
+
+  do {
+
+    Checkpoint point = checkpoint();
+
+    listener.begin( FirstPlus::statements_p0 );
+
+    if( statement() ) {
+
+      if( continuations.size() == point.continuations ) {
+        listener.end( FirstPlus::statements_p0 );
+      }
 
-  // Add your code here
+    } else if( !recover( Recovery::statement, point ) ) {
 
-    if (statement()) return statements_0();
-  
+      fail_state = true;
+      return(false);
 
+    }
 
-  fail_state = true;
-  return false;
+    while( !check_first_plus_set( cursor.current(), FirstPlus::statements_0_p0 ) ) {
 
-}
+      if( (cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != "}") ) {
 
-// TODO: Implement this function
-bool Parser::func_6(void) {
+        bool recovered = false;
 
-  // <func_6>                     --> <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
-  //                                | right_brace                     FIRST_PLUS = { right_brace }
+        if( check_first_plus_set( cursor.current(), FirstPlus::data_decls_p0 ) ) {
+          report_error( cursor.position() );
+          recovered = !stopped && data_decls();
+        } else {
+          recovered = recover( Recovery::statement, checkpoint() );
+        }
 
-  // Add your code here
-  
-    if (check_first_plus_set(current_word, FirstPlus::statements_p0)) {
-    if (statements()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-        get_next_word();  
-        return true;
+        if( !recovered ) {
+          fail_state = true;
+          return(false);
+        }
+
+        continue;
+
+      }
+
+      if( continuations.size() == base ) {
+        break;
+      }
+
+      FirstPlus owner = (continuations.back() == Continuation::if_block) ? FirstPlus::statement_p1 : FirstPlus::statement_p2;
+
+      get_next_word();
+      continuations.pop_back();
+
+      if( ast ) {
+        ast_close();
+        ast_close();
       }
+
+      listener.end( FirstPlus::func_3_p0 );
+      listener.end( FirstPlus::block_statements_p0 );
+      listener.end( owner );
+      listener.end( FirstPlus::statements_p0 );
+
     }
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-    get_next_word();  
-    fail_state = false; 
-    return true;
-  }
 
-  fail_state = true;
-  return false;
+  } while( check_first_plus_set( cursor.current(), FirstPlus::statements_0_p0 ) );
+
+  fail_state = false;
+  return( true );
 
 }
 
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::id_list(void) {
 
-bool Parser::id_list(void) {
+  PROFILE_RULE( id_list );
 
   // <id_list>                    --> <id> <id_list_0>                     FIRST_PLUS = { ID }
 
-  if( check_first_plus_set( current_word, FirstPlus::id_list_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::id_list_p0 ) ) {
 
-    ++variable_count;
+    listener.begin( FirstPlus::id_list_p0 );
       
     if ( id() ) {
 
       if ( id_list_0() ) {
 	
+        listener.end( FirstPlus::id_list_p0 );
         return( true );
 
       }
@@ -1186,25 +2221,10 @@ bool Parser::id_list(void) {
 }
 
 // TODO: Implement this function
-bool Parser::data_decls_0(void) {
-
-  // <data_decls_0>               --> <data_decls>                     FIRST_PLUS = { binary decimal int void }
-  //                                | EPSILON                     FIRST_PLUS = { EPSILON ID break continue if print read return right_brace while write }
-
-  // Add your code here
-
-    if (check_first_plus_set(current_word, FirstPlus::data_decls_0_p0)) return data_decls();
-  
-
-  fail_state = false; 
-  return true;
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::statement(void) {
 
-
-
-}
-
-// TODO: Implement this function
-bool Parser::statement(void) {
+  PROFILE_RULE( statement );
 
   // <statement>                  --> ID <statement_0>                     FIRST_PLUS = { ID }
   //                                | if left_parenthesis <condition_expression> right_parenthesis <block_statements>                     FIRST_PLUS = { if }
@@ -1218,92 +2238,122 @@ bool Parser::statement(void) {
 
 
   // Add your code here
-
-  ++statement_count; 
+  //
+  // An if or while whose block is left open is ended by statements() when it closes.
 
 
-   if (current_word.get_token_type() == TokenType::IDENTIFIER) { get_next_word(); return statement_0();
+   if (cursor.current().get_token_type() == TokenType::IDENTIFIER) {
+    listener.begin( FirstPlus::statement_p0 );
+    name_token = cursor.position(); get_next_word();
+    if (!statement_0()) { return false; }
+    listener.end( FirstPlus::statement_p0 );
+    return true;
   } 
   
-  else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() =="if") {
+  else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() =="if") {
+    listener.begin( FirstPlus::statement_p1 );
+    if( ast ) { ast_open( NodeKind::if_statement, cursor.position() ); }
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
       get_next_word(); 
       if (condition_expression()) {
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
           get_next_word();  
-          return block_statements();
+          return block_statements( FirstPlus::statement_p1 );
         }
       }
     }
   }
-   else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "while") {
+   else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "while") {
+    listener.begin( FirstPlus::statement_p2 );
+    if( ast ) { ast_open( NodeKind::while_statement, cursor.position() ); }
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
       get_next_word();  
       if (condition_expression()) {
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
           get_next_word();  
-          return block_statements();
+          return block_statements( FirstPlus::statement_p2 );
         }
       }
     }
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "return") {
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "return") {
+    listener.begin( FirstPlus::statement_p3 );
+    if( ast ) { ast_open( NodeKind::return_statement, cursor.position() ); }
     get_next_word();  
-    return statement_2();
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "break") {
+    bool matched = statement_2();
+    if( ast ) { ast_close(); }
+    if( matched ) { listener.end( FirstPlus::statement_p3 ); }
+    return matched;
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "break") {
+    listener.begin( FirstPlus::statement_p4 );
+    if( ast ) { ast_leaf( NodeKind::break_statement, cursor.position() ); }
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
       get_next_word();  
+      listener.end( FirstPlus::statement_p4 );
       fail_state = false; 
       return true;
       
     }
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "continue") {
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "continue") {
+    listener.begin( FirstPlus::statement_p5 );
+    if( ast ) { ast_leaf( NodeKind::continue_statement, cursor.position() ); }
     get_next_word(); 
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
       get_next_word();  
+      listener.end( FirstPlus::statement_p5 );
       return true;
     }
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "read") {
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "read") {
+    listener.begin( FirstPlus::statement_p6 );
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
       get_next_word();  
-      if (current_word.get_token_type() == TokenType::IDENTIFIER) {
+      if (cursor.current().get_token_type() == TokenType::IDENTIFIER) {
+        if( ast ) { ast_leaf( NodeKind::read_statement, cursor.position() ); }
         get_next_word(); 
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
           get_next_word(); 
-          if(current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+          if(cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
             get_next_word();  
+            listener.end( FirstPlus::statement_p6 );
             return true;
           }
         }
       }
     }
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD &&  current_word.get_token_name() == "write") {
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD &&  cursor.current().get_token_name() == "write") {
+    listener.begin( FirstPlus::statement_p7 );
+    if( ast ) { ast_open( NodeKind::write_statement, cursor.position() ); }
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
       get_next_word();  
       if (expression()) {
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
           get_next_word();  
-          if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+          if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
+            if( ast ) { ast_close(); }
             get_next_word();  
+            listener.end( FirstPlus::statement_p7 );
             return true;
           }
         }
       }
     }
-  } else if (current_word.get_token_type() == TokenType::RESERVED_WORD && current_word.get_token_name() == "print") {
+  } else if (cursor.current().get_token_type() == TokenType::RESERVED_WORD && cursor.current().get_token_name() == "print") {
+    listener.begin( FirstPlus::statement_p8 );
     get_next_word(); 
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
       get_next_word();  
-      if (current_word.get_token_type() == TokenType::STRING) {
+      if (cursor.current().get_token_type() == TokenType::STRING) {
+        if( ast ) { ast_leaf( NodeKind::print_statement, cursor.position() ); }
         get_next_word(); 
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
           get_next_word(); 
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
             get_next_word();  
+            listener.end( FirstPlus::statement_p8 );
             fail_state = false; 
             return true;
           
@@ -1320,35 +2370,20 @@ bool Parser::statement(void) {
   
 }
 
-// TODO: Implement this function
-bool Parser::statements_0(void) {
-
-  // <statements_0>               --> <statements>                     FIRST_PLUS = { ID break continue if print read return while write }
-  //                                | EPSILON                     FIRST_PLUS = { EPSILON right_brace }
-
-  // Add your code here
-
-
-    if (check_first_plus_set(current_word, FirstPlus::statements_0_p0)) return statements();
-  
-
-  fail_state = false; 
-  return true;
-
-
-
-
-}
-
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::expr_list(void) {
 
-bool Parser::expr_list(void) {
+  PROFILE_RULE( expr_list );
 
   // <expr_list>                  --> <non_empty_expr_list>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
 
-  if( check_first_plus_set( current_word, FirstPlus::expr_list_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::expr_list_p0 ) ) {
+
+    listener.begin( FirstPlus::expr_list_p0 );
 
     if ( non_empty_expr_list() ) {
 
+      listener.end( FirstPlus::expr_list_p0 );
       return( true );
 
     }
@@ -1362,7 +2397,10 @@ bool Parser::expr_list(void) {
 }
 
 // TODO: Implement this function
-bool Parser::statement_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::statement_0(void) {
+
+  PROFILE_RULE( statement_0 );
 
   // <statement_0>                --> equal_sign <expression> semicolon                     FIRST_PLUS = { equal_sign }
   //                                | left_bracket <expression> right_bracket equal_sign <expression> semicolon                     FIRST_PLUS = { left_bracket }
@@ -1371,24 +2409,39 @@ bool Parser::statement_0(void) {
   // Add your code here
 
 
-   if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "=") {
+   if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "=") {
+    listener.begin( FirstPlus::statement_0_p0 );
+    if( ast ) {
+      ast_open( NodeKind::assignment, name_token );
+      ast_leaf( NodeKind::identifier, name_token );
+    }
     get_next_word(); 
     if (expression()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
+        if( ast ) { ast_close(); }
         get_next_word();  
+        listener.end( FirstPlus::statement_0_p0 );
         return true;
       }
     }
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "[") {
+  } else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "[") {
+    listener.begin( FirstPlus::statement_0_p1 );
+    if( ast ) {
+      ast_open( NodeKind::assignment, name_token );
+      ast_open( NodeKind::index, name_token );
+    }
     get_next_word(); 
     if (expression()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL &&  current_word.get_token_name() == "]") {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL &&  cursor.current().get_token_name() == "]") {
+        if( ast ) { ast_close(); }
         get_next_word();  
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "=") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "=") {
           get_next_word(); 
           if (expression()) {
-            if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+            if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
+              if( ast ) { ast_close(); }
               get_next_word(); 
+              listener.end( FirstPlus::statement_0_p1 );
               return true;
             }; 
           };
@@ -1396,9 +2449,14 @@ bool Parser::statement_0(void) {
       };
     };
   }
-   else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "(") {
+   else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "(") {
+    listener.begin( FirstPlus::statement_0_p2 );
+    if( ast ) { ast_open( NodeKind::call, name_token ); }
     get_next_word();    
-    return statement_1();
+    bool matched = statement_1();
+    if( ast ) { ast_close(); }
+    if( matched ) { listener.end( FirstPlus::statement_0_p2 ); }
+    return matched;
   }
 
   fail_state = true;
@@ -1408,16 +2466,26 @@ bool Parser::statement_0(void) {
 }
 
 
-bool Parser::condition_expression(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::condition_expression(void) {
+
+  PROFILE_RULE( condition_expression );
 
   // <condition_expression>       --> <condition> <condition_expression_0>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
 
-  if( check_first_plus_set( current_word, FirstPlus::condition_expression_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::condition_expression_p0 ) ) {
+
+    listener.begin( FirstPlus::condition_expression_p0 );
+
+    if( ast ) { ast_open( NodeKind::condition, Ast::no_token ); }
 
     if ( condition() ) {
 
       if ( condition_expression_0() ) {
 
+        if( ast ) { ast_close(); }
+
+        listener.end( FirstPlus::condition_expression_p0 );
         return( true );
 
       }
@@ -1432,36 +2500,86 @@ bool Parser::condition_expression(void) {
 
 }
 
-// TODO: Implement this function
-bool Parser::block_statements(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::block_statements( FirstPlus owner ) {
 
-  // <block_statements>           --> left_brace <block_statements_0>                     FIRST_PLUS = { left_brace }
+  PROFILE_RULE( block_statements );
 
-  // Add your code here
+  // <block_statements>           --> left_brace <func_3>                     FIRST_PLUS = { left_brace }
+  // <func_3>                     --> <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
+  //                                | right_brace                     FIRST_PLUS = { right_brace }
+  //
+  // An empty block is matched here.  Otherwise the block is left open on the continuation
+  // stack; statements() parses its contents and matches the closing right_brace.  The same
+  // goes for the block's tree node and that of the if or while statement owning it, 'owner'.
+  // A block that starts with what no statement starts with is left open all the same, for
+  // statements() to report it, so that its right_brace still closes the block.
+
+  if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "{") {
+
+    listener.begin( FirstPlus::block_statements_p0 );
+
+    if( ast ) { ast_open( NodeKind::block, cursor.position() ); }
+
+    get_next_word();
+
+    if( (cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != "}") ) {
+
+      Continuation block = (owner == FirstPlus::statement_p1) ? Continuation::if_block : Continuation::while_block;
+
+      if( push_continuation( block ) ) {
+
+        listener.begin( FirstPlus::func_3_p0 );
+
+        return( true );
+
+      }
+
+    } else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == "}") {
+
+      //------------------------------------------------------------
+      // The empty block ends the if or while that owns it as well.
+      //------------------------------------------------------------
+
+      if( ast ) {
+        ast_close();
+        ast_close();
+      }
+
+      listener.begin( FirstPlus::func_3_p1 );
+      get_next_word();
+      listener.end( FirstPlus::func_3_p1 );
+      listener.end( FirstPlus::block_statements_p0 );
+      listener.end( owner );
+      fail_state = false;
+      return( true );
+
+    }
 
-   if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "{") {
-    get_next_word();  
-    return block_statements_0();
   }
 
   fail_state = true;
   return false;
 
-
 }
 
 // TODO: Implement this function
-bool Parser::statement_2(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::statement_2(void) {
+
+  PROFILE_RULE( statement_2 );
 
   // <statement_2>                --> <expression> semicolon                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
   //                                | semicolon                     FIRST_PLUS = { semicolon }
 
   // Add your code here
 
-   if (check_first_plus_set(current_word, FirstPlus::statement_2_p0)) {
+   if (check_first_plus_set(cursor.current(), FirstPlus::statement_2_p0)) {
+    listener.begin( FirstPlus::statement_2_p0 );
     if (expression()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
         get_next_word(); 
+        listener.end( FirstPlus::statement_2_p0 );
         fail_state = false; 
         return true;
       }
@@ -1469,8 +2587,10 @@ bool Parser::statement_2(void) {
     fail_state = true;
     return false;
   } 
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+  else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
+    listener.begin( FirstPlus::statement_2_p1 );
     get_next_word();
+    listener.end( FirstPlus::statement_2_p1 );
     fail_state = false;   
     return true;
   }
@@ -1481,16 +2601,22 @@ bool Parser::statement_2(void) {
 }
 
 
-bool Parser::non_empty_expr_list(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::non_empty_expr_list(void) {
+
+  PROFILE_RULE( non_empty_expr_list );
 
   // <non_empty_expr_list>        --> <expression> <non_empty_expr_list_0>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
 
-  if( check_first_plus_set( current_word, FirstPlus::non_empty_expr_list_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::non_empty_expr_list_p0 ) ) {
+
+    listener.begin( FirstPlus::non_empty_expr_list_p0 );
 
     if ( expression() ) {
 
       if ( non_empty_expr_list_0() ) {
 
+        listener.end( FirstPlus::non_empty_expr_list_p0 );
         return( true );
 
       }
@@ -1506,29 +2632,36 @@ bool Parser::non_empty_expr_list(void) {
 }
 
 // TODO: Implement this function
-bool Parser::statement_1(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::statement_1(void) {
+
+  PROFILE_RULE( statement_1 );
 
   // <statement_1>                --> <expr_list> right_parenthesis semicolon                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
   //                                | right_parenthesis semicolon                     FIRST_PLUS = { right_parenthesis }
 
   // Add your code here
 
- if (check_first_plus_set(current_word, FirstPlus::expr_list_p0)) {
+ if (check_first_plus_set(cursor.current(), FirstPlus::expr_list_p0)) {
+    listener.begin( FirstPlus::statement_1_p0 );
     if (expr_list()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+      if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
         get_next_word();  
-        if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+        if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
           get_next_word();  
+          listener.end( FirstPlus::statement_1_p0 );
           return true;
         };
       };
     };
   }
   
-  else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ")") {
+  else if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ")") {
+    listener.begin( FirstPlus::statement_1_p1 );
     get_next_word();  
-    if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == ";") {
+    if (cursor.current().get_token_type() == TokenType::SYMBOL && cursor.current().get_token_name() == ";") {
       get_next_word();  
+      listener.end( FirstPlus::statement_1_p1 );
       fail_state = false; 
       return true;
     }
@@ -1541,18 +2674,30 @@ bool Parser::statement_1(void) {
 }
 
 
-bool Parser::condition(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::condition(void) {
+
+  PROFILE_RULE( condition );
 
   // <condition>                  --> <expression> <comparison_op> <expression>                     FIRST_PLUS = { ID NUMBER left_parenthesis minus_sign }
 
-  if( check_first_plus_set( current_word, FirstPlus::condition_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::condition_p0 ) ) {
+
+    listener.begin( FirstPlus::condition_p0 );
+
+    if( ast ) { ast_open( NodeKind::comparison, Ast::no_token ); }
 
     if ( expression() ) {
 
+      if( ast ) { (*ast)[ast_frames.back().node].token = cursor.position(); }
+
       if ( comparison_op() ) {
 
         if ( expression() ) {
 
+          if( ast ) { ast_close(); }
+
+          listener.end( FirstPlus::condition_p0 );
           return( true );
 
         }
@@ -1570,24 +2715,32 @@ bool Parser::condition(void) {
 }
 
 
-bool Parser::condition_expression_0(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::condition_expression_0(void) {
+
+  PROFILE_RULE( condition_expression_0 );
 
   // <condition_expression_0>     --> <condition_op> <condition>                     FIRST_PLUS = { double_and_sign double_or_sign }
   //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
 
-  if( check_first_plus_set( current_word, FirstPlus::condition_expression_0_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::condition_expression_0_p0 ) ) {
+
+    listener.begin( FirstPlus::condition_expression_0_p0 );
+
+    if( ast ) { (*ast)[ast_frames.back().node].token = cursor.position(); }
 
     if ( condition_op() ) {
 
       if ( condition() ) {
 
+        listener.end( FirstPlus::condition_expression_0_p0 );
         return( true );
 
       }
 
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::condition_expression_0_p1 ) ) {
+  } else if( check_first_plus_set( cursor.current(), FirstPlus::condition_expression_0_p1 ) ) {
 
       // EPSILON consumes no tokens.
 
@@ -1601,66 +2754,33 @@ bool Parser::condition_expression_0(void) {
 
 }
 
-// TODO: Implement this function
-bool Parser::block_statements_0(void) {
-
-  // <block_statements_0>         --> <statements> right_brace                     FIRST_PLUS = { ID break continue if print read return while write }
-  //                                | right_brace                     FIRST_PLUS = { right_brace }
-
-
-  // Add your code here
-
-
-
-  if (check_first_plus_set(current_word, FirstPlus::statements_p0)) {
-    if (statements()) {
-      if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-        get_next_word();  
-        fail_state = false; 
-        return true;
-      }
-    }
-  } else if (current_word.get_token_type() == TokenType::SYMBOL && current_word.get_token_name() == "}") {
-    get_next_word();  
-    fail_state = false; 
-    return true;
-  }
-
-  fail_state = true;
-  return false;
-
-
-
-
-}
-
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::non_empty_expr_list_0(void) {
 
-bool Parser::non_empty_expr_list_0(void) {
+  PROFILE_RULE( non_empty_expr_list_0 );
 
   // <non_empty_expr_list_0>      --> comma <expression> <non_empty_expr_list_0>                     FIRST_PLUS = { comma }
   //                                | EPSILON                     FIRST_PLUS = { EPSILON right_parenthesis }
+  //
+  // One argument per pass of the loop; the EPSILON production ends it.
 
-  if( check_first_plus_set( current_word, FirstPlus::non_empty_expr_list_0_p0 ) ) {
-
-    if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == ",")  ) {
-
-      if( get_next_word() ) {
-
-        if ( expression() ) {
+  while( check_first_plus_set( cursor.current(), FirstPlus::non_empty_expr_list_0_p0 ) ) {
 
-          if ( non_empty_expr_list_0() ) {
+    listener.begin( FirstPlus::non_empty_expr_list_0_p0 );
 
-            return( true );
+    if ( (cursor.current().get_token_type() != TokenType::SYMBOL) || (cursor.current().get_token_name() != ",") ||
+         !get_next_word() || !expression() ) {
 
-          }
+      fail_state = true;
+      return(false);
 
-        }
+    }
 
-      }
+    listener.end( FirstPlus::non_empty_expr_list_0_p0 );
 
-    }
+  }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::non_empty_expr_list_0_p1 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::non_empty_expr_list_0_p1 ) ) {
 
       // EPSILON consumes no tokens.
 
@@ -1675,7 +2795,10 @@ bool Parser::non_empty_expr_list_0(void) {
 }
 
 // TODO: Implement this function
-bool Parser::comparison_op(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::comparison_op(void) {
+
+  PROFILE_RULE( comparison_op );
 
   // <comparison_op>              --> ==                     FIRST_PLUS = { == }
   //                                | !=                     FIRST_PLUS = { != }
@@ -1685,13 +2808,19 @@ bool Parser::comparison_op(void) {
   //                                | <=                     FIRST_PLUS = { <= }
 
   // Add your code here
-   if (current_word.get_token_type() == TokenType::SYMBOL) {
-    if (current_word.get_token_name() == "==" || current_word.get_token_name() == "!=" ||
-        current_word.get_token_name() == ">" || current_word.get_token_name() == ">=" ||
-        current_word.get_token_name() == "<" || current_word.get_token_name() == "<=") {
-      get_next_word();
-      return true;
-    }
+   if (cursor.current().get_token_type() == TokenType::SYMBOL) {
+    FirstPlus production;
+    if (cursor.current().get_token_name() == "==") { production = FirstPlus::comparison_op_p0; }
+    else if (cursor.current().get_token_name() == "!=") { production = FirstPlus::comparison_op_p1; }
+    else if (cursor.current().get_token_name() == ">") { production = FirstPlus::comparison_op_p2; }
+    else if (cursor.current().get_token_name() == ">=") { production = FirstPlus::comparison_op_p3; }
+    else if (cursor.current().get_token_name() == "<") { production = FirstPlus::comparison_op_p4; }
+    else if (cursor.current().get_token_name() == "<=") { production = FirstPlus::comparison_op_p5; }
+    else { fail_state = true; return false; }
+    listener.begin( production );
+    get_next_word();
+    listener.end( production );
+    return true;
   }
   
   fail_state = true;
@@ -1701,29 +2830,38 @@ bool Parser::comparison_op(void) {
 
 }
 
-bool Parser::condition_op(void) {
+template< typename Listener, typename Source >
+bool BasicParser<Listener, Source>::condition_op(void) {
+
+  PROFILE_RULE( condition_op );
 
   // <condition_op>               --> double_and_sign                     FIRST_PLUS = { double_and_sign }
   //                                | double_or_sign                     FIRST_PLUS = { double_or_sign }
 
-  if( check_first_plus_set( current_word, FirstPlus::condition_op_p0 ) ) {
+  if( check_first_plus_set( cursor.current(), FirstPlus::condition_op_p0 ) ) {
+
+    if ( (cursor.current().get_token_type() == TokenType::SYMBOL) && (cursor.current().get_token_name() == "&&")  ) {
 
-    if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == "&&")  ) {
+      listener.begin( FirstPlus::condition_op_p0 );
 
       if( get_next_word() ) {
 
+        listener.end( FirstPlus::condition_op_p0 );
         return( true );
 
       }
 
     }
 
-  } else if( check_first_plus_set( current_word, FirstPlus::condition_op_p1 ) ) {
+  } else if( check_first_plus_set( cursor.current(), FirstPlus::condition_op_p1 ) ) {
 
-    if ( (current_word.get_token_type() == TokenType::SYMBOL) && (current_word.get_token_name() == "||")  ) {
+    if ( (cursor.current().get_token_type() == TokenType::SYMBOL) && (cursor.current().get_token_name() == "||")  ) {
+
+      listener.begin( FirstPlus::condition_op_p1 );
 
       if( get_next_word() ) {
 
+        listener.end( FirstPlus::condition_op_p1 );
         return( true );
 
       }
@@ -1736,4 +2874,12 @@ bool Parser::condition_op(void) {
 
   return(false);
 
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------------------------
+// The listeners and token sources the parser is built for.  A new pair is added here.
+//----------------------------------------------------------------------------------------------
+
+template class BasicParser<NullListener>;
+template class BasicParser<CountListener>;
+template class BasicParser<CountListener, TokenTable>;
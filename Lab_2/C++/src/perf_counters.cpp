@@ -0,0 +1,172 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char * const event_names[] = {
+  "cycles", "instructions", "branch-misses", "L1D-misses", "LLC-misses", "page-faults"
+};
+
+PerfCounters::PerfCounters() {
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+    descriptors[event] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+    if( descriptors[event] >= 0 ) {
+      close( descriptors[event] );
+    }
+  }
+#endif
+}
+
+const char * PerfCounters::get_name( PerfEvent event ) {
+
+  return( event_names[static_cast<std::size_t>( event )] );
+
+}
+
+//-----------------------------------------------------------------------------
+// A counter that was enabled between the samples but never counting has no
+// count to scale, and is taken to have counted nothing, as is one whose later
+// sample is behind the earlier, such as after a read that failed.
+//-----------------------------------------------------------------------------
+
+std::uint64_t PerfCounters::difference( const PerfSample & before, const PerfSample & after, PerfEvent event ) {
+
+  std::size_t index = static_cast<std::size_t>( event );
+
+  if( (after.values[index] < before.values[index]) || (after.enabled[index] < before.enabled[index]) ||
+      (after.running[index] < before.running[index]) ) {
+    return(0);
+  }
+
+  std::uint64_t count = after.values[index] - before.values[index];
+  std::uint64_t enabled = after.enabled[index] - before.enabled[index];
+  std::uint64_t running = after.running[index] - before.running[index];
+
+  if( running < enabled ) {
+    count = (running > 0) ? static_cast<std::uint64_t>( static_cast<double>( count ) * enabled / running ) : 0;
+  }
+
+  return( count );
+
+}
+
+#ifdef __linux__
+
+//-----------------------------------------------------------------------------
+// The type and configuration of each event.  The cache misses are those of
+// reads, the L1 data cache's and the last level cache's.
+//-----------------------------------------------------------------------------
+
+static const std::uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+static const std::uint32_t event_types[] = {
+  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE
+};
+
+static const std::uint64_t event_configs[] = {
+  PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_HW_CACHE_L1D | cache_read_miss, PERF_COUNT_HW_CACHE_LL | cache_read_miss, PERF_COUNT_SW_PAGE_FAULTS
+};
+
+bool PerfCounters::open( std::string & error_message ) {
+
+  int error = 0;
+  bool any = false;
+
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+
+    struct perf_event_attr attributes;
+
+    std::memset( &attributes, 0, sizeof( attributes ) );
+    attributes.size = sizeof( attributes );
+    attributes.type = event_types[event];
+    attributes.config = event_configs[event];
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    if( descriptors[event] < 0 ) {
+      descriptors[event] = static_cast<int>( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+    }
+
+    error = (descriptors[event] < 0) ? errno : error;
+    any = any || (descriptors[event] >= 0);
+
+  }
+
+  if( any ) {
+    return(true);
+  }
+
+  if( (error == EACCES) || (error == EPERM) ) {
+    error_message = "perf_event_open is not permitted, see /proc/sys/kernel/perf_event_paranoid.";
+  } else {
+    error_message = std::string( "perf_event_open failed:  " ) + std::strerror( error ) + ".";
+  }
+
+  return(false);
+
+}
+
+PerfSample PerfCounters::read( void ) const {
+
+  PerfSample sample;
+
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+
+    std::uint64_t value[3] = { 0, 0, 0 };
+
+    if( descriptors[event] >= 0 ) {
+      if( ::read( descriptors[event], value, sizeof( value ) ) != sizeof( value ) ) {
+	value[0] = value[1] = value[2] = 0;
+      }
+    }
+
+    sample.values[event]  = value[0];
+    sample.enabled[event] = value[1];
+    sample.running[event] = value[2];
+
+  }
+
+  return( sample );
+
+}
+
+#else
+
+bool PerfCounters::open( std::string & error_message ) {
+
+  error_message = "perf_event_open is Linux only.";
+
+  return(false);
+
+}
+
+PerfSample PerfCounters::read( void ) const {
+
+  PerfSample sample;
+
+  for( std::size_t event = 0; event < perf_event_count; ++event ) {
+    sample.values[event] = sample.enabled[event] = sample.running[event] = 0;
+  }
+
+  return( sample );
+
+}
+
+#endif
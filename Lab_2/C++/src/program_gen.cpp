@@ -0,0 +1,128 @@
+#include "grammar.h"
+#include "program_generator.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// A size in bytes, with an optional K, M or G for binary kilo, mega and giga.
+//-----------------------------------------------------------------------------
+
+static std::uint64_t read_size( const std::string & text ) {
+
+  char *end = nullptr;
+  std::uint64_t size = std::strtoull( text.c_str(), &end, 10 );
+
+  switch( *end ) {
+  case 'K' : { return( size << 10 ); }
+  case 'M' : { return( size << 20 ); }
+  case 'G' : { return( size << 30 ); }
+  default  : { return( size ); }
+  }
+
+}
+
+auto main( int argc, char **argv ) -> int {
+
+  //-----------------------------------------------------------------------------
+  // Expect the grammar and output file names as the last arguments, optionally
+  // preceded by '--seed <n>', '--size <bytes>' for the size to aim at, 1K when
+  // not given, '--max-depth <n>' for how deeply blocks and expressions may
+  // nest, '--mutations <n>' for an invalid program with that many mutations,
+  // and '--weight <nonterminal>=<w>,<w>,...' for the weights of a
+  // nonterminal's productions, which may be given for several nonterminals.
+  // See program_generator.h.
+  //-----------------------------------------------------------------------------
+
+  std::uint64_t seed = 1;
+  std::uint64_t size = 1 << 10;
+  unsigned max_depth = 16;
+  unsigned mutations = 0;
+  std::vector<std::string> weight_options;
+  int arg = 1;
+
+  for( ; arg < argc-2; ++arg ) {
+
+    std::string option( argv[arg] );
+
+    if( (option == "--seed") && (arg+1 < argc-2) ) {
+      seed = std::strtoull( argv[++arg], nullptr, 10 );
+    } else if( (option == "--size") && (arg+1 < argc-2) ) {
+      size = read_size( argv[++arg] );
+    } else if( (option == "--max-depth") && (arg+1 < argc-2) ) {
+      max_depth = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--mutations") && (arg+1 < argc-2) ) {
+      mutations = static_cast<unsigned>( std::strtoul( argv[++arg], nullptr, 10 ) );
+    } else if( (option == "--weight") && (arg+1 < argc-2) ) {
+      weight_options.push_back( argv[++arg] );
+    } else {
+      std::cout << "Error:  Unknown option '" << option << "'." << std::endl;
+      return(1);
+    }
+
+  }
+
+  if( arg != argc-2 ) {
+    std::cout << "Error:  Expecting a grammar file name and an output file name as the last arguments." << std::endl;
+    return(1);
+  }
+
+  Grammar grammar;
+  std::string error_message;
+
+  if( !grammar.load( argv[arg], error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  ProgramGenerator generator( grammar );
+
+  generator.set_seed( seed );
+  generator.set_target_size( size );
+  generator.set_max_depth( max_depth );
+  generator.set_mutation_count( mutations );
+
+  for( const std::string & option : weight_options ) {
+
+    std::size_t equals = option.find( '=' );
+    std::vector<unsigned> weights;
+
+    if( equals != std::string::npos ) {
+      std::istringstream list( option.substr( equals + 1 ) );
+      std::string weight;
+      while( std::getline( list, weight, ',' ) ) {
+	weights.push_back( static_cast<unsigned>( std::strtoul( weight.c_str(), nullptr, 10 ) ) );
+      }
+    }
+
+    if( !generator.set_weights( option.substr( 0, equals ), weights, error_message ) ) {
+      std::cout << "Error:  " << error_message << std::endl;
+      return(1);
+    }
+
+  }
+
+  std::ofstream out( argv[arg+1], std::ios::out | std::ios::binary | std::ios::trunc );
+
+  if( !out.is_open() ) {
+    std::cout << "Error:  Failed to open file '" << argv[arg+1] << "'." << std::endl;
+    return(1);
+  }
+
+  std::uint64_t written = 0;
+
+  if( !generator.generate( out, written, error_message ) ) {
+    std::cout << "Error:  " << error_message << std::endl;
+    return(1);
+  }
+
+  std::cout << "bytes " << written << " mutation " << generator.get_mutations_made() << std::endl;
+
+  return(0);
+
+}
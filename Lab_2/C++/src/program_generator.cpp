@@ -0,0 +1,385 @@
+#include "program_generator.h"
+
+#include "grammar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// The lines the programs of test/all_tests begin with.  They are meta
+// statements to the scanner, which leaves them out.
+//-----------------------------------------------------------------------------
+
+static const char program_header[] =
+  "#include <stdio.h>\n"
+  "#define read(x) scanf(\"%d\",&x)\n"
+  "#define write(x) printf(\"%d\\n\",x)\n"
+  "#define print(x) printf(x)\n"
+  "\n";
+
+static const std::size_t flush_size = 1 << 16;
+static const unsigned no_height = 0xffffffff;
+
+ProgramGenerator::ProgramGenerator( const Grammar & grammar ) :
+  grammar(grammar), seed{0}, target_size{0}, max_depth{8}, mutation_count{0}, mutations_made{0},
+  state{0}, mutation_state{0}, first_production{}, production_count{}, shortest{},
+  weights( grammar.get_production_count(), 1 ), productive{}, spellings{}, token{},
+  stack{}, buffer{}, written{0}, braces{0}, line_start{true}
+{
+  analyze();
+}
+
+ProgramGenerator::~ProgramGenerator() {
+}
+
+//-----------------------------------------------------------------------------
+// The height of a nonterminal is that of its shallowest derivation tree, by
+// iterating to a fixed point.  Its shortest production is the one that tree
+// starts with, and every nonterminal in that production is lower, so always
+// choosing the shortest production ends a derivation.
+//-----------------------------------------------------------------------------
+
+void ProgramGenerator::analyze( void ) {
+
+  std::uint32_t terminal_count = grammar.get_terminal_count();
+  std::uint32_t nonterminal_count = grammar.get_nonterminal_count();
+  std::uint32_t productions = grammar.get_production_count();
+  std::vector<unsigned> height( nonterminal_count, no_height );
+
+  first_production.assign( nonterminal_count, 0 );
+  production_count.assign( nonterminal_count, 0 );
+  shortest.assign( nonterminal_count, Grammar::no_production );
+  productive.assign( productions, false );
+
+  for( std::uint32_t production = productions; production-- > 0; ) {
+    std::uint32_t nonterminal = grammar.get_lhs( production ) - terminal_count;
+    first_production[nonterminal] = production;
+    ++production_count[nonterminal];
+  }
+
+  spellings.clear();
+
+  for( std::uint32_t terminal = 0; terminal < terminal_count; ++terminal ) {
+    spellings.push_back( grammar.get_spelling( terminal ) );
+  }
+
+  for( bool changed = true; changed; ) {
+
+    changed = false;
+
+    for( std::uint32_t production = 0; production < productions; ++production ) {
+
+      unsigned tallest = 0;
+
+      for( const std::uint32_t *symbol = grammar.begin_of( production ); symbol != grammar.end_of( production ); ++symbol ) {
+	if( !grammar.is_terminal( *symbol ) ) {
+	  tallest = std::max( tallest, height[*symbol - terminal_count] );
+	}
+      }
+
+      std::uint32_t nonterminal = grammar.get_lhs( production ) - terminal_count;
+
+      if( (tallest != no_height) && (tallest + 1 < height[nonterminal]) ) {
+	height[nonterminal] = tallest + 1;
+	shortest[nonterminal] = production;
+	changed = true;
+      }
+
+      productive[production] = (tallest != no_height);
+
+    }
+
+  }
+
+}
+
+bool ProgramGenerator::set_weights( const std::string & nonterminal,
+				    const std::vector<unsigned> & weights,
+				    std::string & error_message ) {
+
+  std::uint32_t terminal_count = grammar.get_terminal_count();
+
+  for( std::uint32_t symbol = terminal_count; symbol < terminal_count + grammar.get_nonterminal_count(); ++symbol ) {
+
+    if( grammar.get_name( symbol ) != nonterminal ) {
+      continue;
+    }
+
+    if( weights.size() != production_count[symbol - terminal_count] ) {
+      error_message = nonterminal + " has " + std::to_string( production_count[symbol - terminal_count] ) +
+	" productions, not " + std::to_string( weights.size() ) + ".";
+      return(false);
+    }
+
+    std::copy( weights.begin(), weights.end(), this->weights.begin() + first_production[symbol - terminal_count] );
+
+    return(true);
+
+  }
+
+  error_message = "The grammar has no rule for " + nonterminal + ".";
+
+  return(false);
+
+}
+
+//-----------------------------------------------------------------------------
+// splitmix64, which is the same everywhere, unlike the distributions of
+// <random>.
+//-----------------------------------------------------------------------------
+
+std::uint64_t ProgramGenerator::random( std::uint64_t & state, std::uint64_t bound ) {
+
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+  return( (z ^ (z >> 31)) % bound );
+
+}
+
+bool ProgramGenerator::generate( std::ostream & out, std::uint64_t & size, std::string & error_message ) {
+
+  std::uint32_t start = grammar.get_start();
+
+  if( shortest[start - grammar.get_terminal_count()] == Grammar::no_production ) {
+    error_message = "The start symbol " + grammar.get_name( start ) + " derives no program.";
+    return(false);
+  }
+
+  state = seed;
+  mutation_state = ~seed;
+  mutations_made = 0;
+  stack.assign( 1, Pending{ start, 0 } );
+  buffer.clear();
+  written = 0;
+  braces = 0;
+  line_start = true;
+
+  std::vector<std::uint64_t> mutation_points;
+
+  for( unsigned mutation = 0; mutation < mutation_count; ++mutation ) {
+    mutation_points.push_back( random( mutation_state, std::max<std::uint64_t>( target_size, 1 ) ) );
+  }
+
+  std::sort( mutation_points.begin(), mutation_points.end() );
+
+  write( program_header, out );
+
+  std::size_t nonterminals = 1;
+
+  while( !stack.empty() ) {
+
+    if( (mutations_made < mutation_points.size()) && (written >= mutation_points[mutations_made]) && mutate( out ) ) {
+      ++mutations_made;
+      continue;
+    }
+
+    Pending next = stack.back();
+    stack.pop_back();
+
+    if( grammar.is_terminal( next.symbol ) ) {
+      write( spell( next.symbol, state ), out );
+      continue;
+    }
+
+    bool top_level = (--nonterminals == 0);
+    std::uint32_t production = choose( next.symbol, next.depth, top_level );
+    unsigned depth = top_level ? 0 : next.depth;
+
+    for( const std::uint32_t *symbol = grammar.end_of( production ); symbol != grammar.begin_of( production ); ) {
+      --symbol;
+      stack.push_back( Pending{ *symbol, depth + ((symbol + 1 != grammar.end_of( production )) ? 1 : 0) } );
+      nonterminals += grammar.is_terminal( *symbol ) ? 0 : 1;
+    }
+
+  }
+
+  out.write( buffer.data(), static_cast<std::streamsize>( buffer.size() ) );
+  out.flush();
+
+  if( !out ) {
+    error_message = "Failed to write the program.";
+    return(false);
+  }
+
+  size = written;
+
+  return(true);
+
+}
+
+std::uint32_t ProgramGenerator::choose( std::uint32_t nonterminal, unsigned depth, bool top_level ) {
+
+  std::uint32_t index = nonterminal - grammar.get_terminal_count();
+  std::uint32_t first = first_production[index];
+  std::uint32_t last = first + production_count[index];
+  bool grow = top_level;
+
+  if( top_level ? (written >= target_size)
+      : ((depth > max_depth) || (random( state, (max_depth + 1) * (max_depth + 1) ) < depth * depth)) ) {
+    return( shortest[index] );
+  }
+
+  //---------------------------------------------------------------------------
+  // Below the target size, a top level list only goes on.  A production
+  // leads on if it has a nonterminal, unless the nonterminal has none that
+  // does.
+  //---------------------------------------------------------------------------
+
+  auto leads_on = [this]( std::uint32_t production ) {
+    return( std::any_of( grammar.begin_of( production ), grammar.end_of( production ),
+			 [this]( std::uint32_t symbol ) { return( !grammar.is_terminal( symbol ) ); } ) );
+  };
+
+  if( grow ) {
+    bool any = false;
+    for( std::uint32_t production = first; production < last; ++production ) {
+      any = any || (productive[production] && (weights[production] > 0) && leads_on( production ));
+    }
+    grow = any;
+  }
+
+  std::uint64_t total = 0;
+
+  for( std::uint32_t production = first; production < last; ++production ) {
+    if( productive[production] && (!grow || leads_on( production )) ) {
+      total += weights[production];
+    }
+  }
+
+  if( total == 0 ) {
+    return( shortest[index] );
+  }
+
+  std::uint64_t pick = random( state, total );
+
+  for( std::uint32_t production = first; production < last; ++production ) {
+
+    if( !productive[production] || (grow && !leads_on( production )) ) {
+      continue;
+    }
+
+    if( pick < weights[production] ) {
+      return( production );
+    }
+
+    pick -= weights[production];
+
+  }
+
+  return( shortest[index] );
+
+}
+
+const std::string & ProgramGenerator::spell( std::uint32_t terminal, std::uint64_t & state ) {
+
+  if( !spellings[terminal].empty() ) {
+    return( spellings[terminal] );
+  }
+
+  const std::string & name = grammar.get_name( terminal );
+
+  if( name == "ID" ) {
+    token = "v" + std::to_string( random( state, 1000 ) );
+  } else if( name == "NUMBER" ) {
+    token = std::to_string( random( state, 100000 ) );
+  } else if( name == "STRING" ) {
+    token = "\"s" + std::to_string( random( state, 1000 ) ) + "\"";
+  } else {
+    token.clear();
+  }
+
+  return( token );
+
+}
+
+//-----------------------------------------------------------------------------
+// Tokens are separated by a space, and a line ends after each semicolon and
+// brace, the next one indented by the braces still open.
+//-----------------------------------------------------------------------------
+
+void ProgramGenerator::write( const std::string & text, std::ostream & out ) {
+
+  if( text.empty() ) {
+    return;
+  }
+
+  std::size_t before = buffer.size();
+
+  if( text == "}" ) {
+    braces = (braces > 0) ? braces - 1 : 0;
+  }
+
+  if( line_start ) {
+    buffer.append( 2 * braces, ' ' );
+  } else {
+    buffer += ' ';
+  }
+
+  buffer += text;
+
+  if( text == "{" ) {
+    ++braces;
+  }
+
+  line_start = (text == ";") || (text == "{") || (text == "}") || (text.back() == '\n');
+
+  if( line_start && (text.back() != '\n') ) {
+    buffer += '\n';
+  }
+
+  written += buffer.size() - before;
+
+  if( buffer.size() >= flush_size ) {
+    out.write( buffer.data(), static_cast<std::streamsize>( buffer.size() ) );
+    buffer.clear();
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// A terminal that cannot come next is one the nonterminal on top of the stack
+// predicts nothing for, or any but the terminal on top.  The parse fails on
+// it either way.  The end of file is never put in, and is never replaced.
+//-----------------------------------------------------------------------------
+
+bool ProgramGenerator::mutate( std::ostream & out ) {
+
+  const Pending & next = stack.back();
+  std::vector<std::uint32_t> invalid;
+
+  for( std::uint32_t terminal = 0; terminal < grammar.get_terminal_count(); ++terminal ) {
+
+    if( grammar.get_name( terminal ) == "eof" ) {
+      continue;
+    }
+
+    if( grammar.is_terminal( next.symbol ) ? (terminal != next.symbol)
+	: (grammar.predict( next.symbol, terminal ) == Grammar::no_production) ) {
+      invalid.push_back( terminal );
+    }
+
+  }
+
+  if( invalid.empty() ) {
+    return(false);
+  }
+
+  std::uint32_t terminal = invalid[random( mutation_state, invalid.size() )];
+
+  if( grammar.is_terminal( next.symbol ) && (grammar.get_name( next.symbol ) != "eof") && (random( mutation_state, 2 ) == 0) ) {
+    spell( next.symbol, state );
+    stack.pop_back();
+  }
+
+  write( spell( terminal, mutation_state ), out );
+
+  return(true);
+
+}
@@ -0,0 +1,38 @@
+#include "parse_main.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// Open a file stored in the string 'filename' for reading.  Store the
+// result in a string_vector as the program text.  Report I/O failures
+// and return false if one happens.
+//-----------------------------------------------------------------------------
+
+bool read_file_to_string_vector( const std::string & filename,
+				 string_vector & file_text ) {
+
+  std::fstream input_file;
+  input_file.open( filename, std::ios::in );
+  
+  if( input_file.is_open() ) {
+    
+    std::string line;
+    
+    while( std::getline( input_file, line ) ) {
+      file_text.push_back(line);
+    }
+    
+    input_file.close();
+
+    return(true);
+    
+  } else {
+
+    std::cout << "Failed to open file '" << filename << "'." << std::endl;
+    return(false);
+    
+  }
+    
+}
@@ -0,0 +1,157 @@
+#include "rule_profile.h"
+
+#ifdef PROFILE_RULES
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const char * const rule_names[] = {
+  "program_start", "program", "type_name", "program_0", "id_0", "id_list_0", "program_1", "func_0",
+  "func_path", "expression", "operand", "operand_suffix", "close_nested_expression", "id",
+  "func_or_data", "parameter_list", "func_1", "func_list", "parameter_list_0", "non_empty_list_0",
+  "func_2", "func", "data_decls", "func_3", "statements", "id_list", "statement", "expr_list",
+  "statement_0", "condition_expression", "block_statements", "statement_2", "non_empty_expr_list",
+  "statement_1", "condition", "condition_expression_0", "non_empty_expr_list_0", "comparison_op",
+  "condition_op"
+};
+
+static std::uint64_t cycles( void ) {
+
+#if defined(__x86_64__) || defined(__i386__)
+  return( __rdtsc() );
+#else
+  return( static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+	    std::chrono::steady_clock::now().time_since_epoch() ).count() ) );
+#endif
+
+}
+
+struct RuleCounts {
+  std::uint64_t calls[rule_count];
+  std::uint64_t inclusive[rule_count];
+  std::uint64_t exclusive[rule_count];
+  std::uint64_t tokens[rule_count];
+};
+
+//-----------------------------------------------------------------------------
+// The profile of the threads that have ended, written out when the program
+// ends.  The main thread's counts are added before, as objects of a thread
+// are destroyed before the static ones.
+//-----------------------------------------------------------------------------
+
+struct RuleProfile {
+
+  std::mutex lock;
+  RuleCounts totals;
+
+  ~RuleProfile() {
+
+    std::vector<std::size_t> order;
+    std::uint64_t all = 0;
+
+    for( std::size_t rule = 0; rule < rule_count; ++rule ) {
+      if( totals.calls[rule] > 0 ) {
+	order.push_back( rule );
+	all += totals.exclusive[rule];
+      }
+    }
+
+    if( order.empty() ) {
+      return;
+    }
+
+    std::stable_sort( order.begin(), order.end(), [this]( std::size_t a, std::size_t b ) {
+	return( totals.exclusive[a] > totals.exclusive[b] );
+      } );
+
+    std::cerr << std::left << std::setw( 26 ) << "rule" << std::right << std::setw( 12 ) << "calls"
+	      << std::setw( 16 ) << "inclusive" << std::setw( 16 ) << "exclusive" << std::setw( 8 ) << "%"
+	      << std::setw( 12 ) << "tokens" << std::endl;
+
+    for( std::size_t rule : order ) {
+      std::cerr << std::left << std::setw( 26 ) << rule_names[rule] << std::right
+		<< std::setw( 12 ) << totals.calls[rule]
+		<< std::setw( 16 ) << totals.inclusive[rule]
+		<< std::setw( 16 ) << totals.exclusive[rule]
+		<< std::setw( 8 ) << std::fixed << std::setprecision( 1 )
+		<< (all ? 100.0 * totals.exclusive[rule] / all : 0.0)
+		<< std::setw( 12 ) << totals.tokens[rule] << std::endl;
+    }
+
+  }
+
+};
+
+static RuleProfile profile{ {}, {} };
+
+//-----------------------------------------------------------------------------
+// The counts of one thread, and its routines being run.
+//-----------------------------------------------------------------------------
+
+struct ThreadCounts {
+
+  RuleCounts counts;
+  unsigned   active[rule_count];
+  RuleScope  *innermost;
+
+  ~ThreadCounts() {
+
+    std::lock_guard<std::mutex> guard( profile.lock );
+
+    for( std::size_t rule = 0; rule < rule_count; ++rule ) {
+      profile.totals.calls[rule]     += counts.calls[rule];
+      profile.totals.inclusive[rule] += counts.inclusive[rule];
+      profile.totals.exclusive[rule] += counts.exclusive[rule];
+      profile.totals.tokens[rule]    += counts.tokens[rule];
+    }
+
+  }
+
+};
+
+static thread_local ThreadCounts thread_counts{ {}, {}, nullptr };
+
+RuleScope::RuleScope( Rule rule ) :
+  rule(rule), caller{thread_counts.innermost},
+  outermost{thread_counts.active[static_cast<std::size_t>( rule )]++ == 0}, callees{0}, start{cycles()}
+{
+  thread_counts.innermost = this;
+}
+
+RuleScope::~RuleScope() {
+
+  std::uint64_t elapsed = cycles() - start;
+  std::size_t index = static_cast<std::size_t>( rule );
+
+  ++thread_counts.counts.calls[index];
+  thread_counts.counts.inclusive[index] += outermost ? elapsed : 0;
+  thread_counts.counts.exclusive[index] += elapsed - std::min( callees, elapsed );
+  --thread_counts.active[index];
+
+  if( caller != nullptr ) {
+    caller->callees += elapsed;
+  }
+
+  thread_counts.innermost = caller;
+
+}
+
+void rule_profile_token( void ) {
+
+  if( thread_counts.innermost != nullptr ) {
+    ++thread_counts.counts.tokens[static_cast<std::size_t>( thread_counts.innermost->rule )];
+  }
+
+}
+
+#endif
@@ -1,9 +1,12 @@
+#include "memory_report.h"
 #include "scanner.h"
 #include "token.h"
 
+#include <cstddef>
 #include <iostream>
 #include <set>
 #include <string>
+#include <utility>
 
 //-----------------------------------------------------------------------------
 // Construct a set with the reserved words for quick lookup.  This declaration
@@ -52,7 +55,8 @@ const std::set<char> Scanner::simple_symbols =
 // The standard parameterized constructor.
 //-----------------------------------------------------------------------------
 
-Scanner::Scanner( const string_vector & text ) : filetext{text}, tokens{}, token_index{0} {
+Scanner::Scanner( const string_vector & text ) :
+  filetext{text}, tokens{}, token_index{0}, spare_tokens{}, spare_used{0} {
 }
 
 
@@ -64,6 +68,47 @@ Scanner::Scanner( const string_vector & text ) : filetext{text}, tokens{}, token
 Scanner::~Scanner() {
 }
 
+std::size_t Scanner::get_text_memory_size( void ) const {
+
+  return( string_vector_memory( filetext ) );
+
+}
+
+std::size_t Scanner::get_token_memory_size( void ) const {
+
+  return( token_vector_memory( tokens ) + token_vector_memory( spare_tokens ) );
+
+}
+
+//-----------------------------------------------------------------------------
+// Assigning the text copies each line into the string already in its place,
+// reusing its buffer.  The tokens become the spares, and the spares, already
+// emptied by add_token(), the vector the new tokens go into.  clear() leaves
+// its capacity alone;  the first reset gives it that of the tokens.
+//-----------------------------------------------------------------------------
+
+void Scanner::reset( const string_vector & text ) {
+
+  filetext = text;
+  tokens.swap( spare_tokens );
+  tokens.clear();
+  tokens.reserve( spare_tokens.capacity() );
+  token_index = 0;
+  spare_used = 0;
+
+}
+
+void Scanner::add_token( TokenType type, const std::string & line, unsigned start, unsigned length, unsigned line_number ) {
+
+  if( spare_used < spare_tokens.size() ) {
+    tokens.push_back( std::move( spare_tokens[spare_used++] ) );
+    tokens.back().assign( type, line, start, length, line_number );
+  } else {
+    tokens.emplace_back( type, line.substr( start, length ), line_number );
+  }
+
+}
+
 
 bool Scanner::has_more_tokens( void ) {
 
@@ -107,11 +152,16 @@ const Token Scanner::get_next_token( void ) {
 //   and finaly number.
 //   If none of the above match then the character represents an illegal
 //   character.
+//
+// Meta statements are recognized and dropped, the parser has no use for them.
+// The end of file token takes the line of the last token or meta statement,
+// for errors at the end of the input.
 //-----------------------------------------------------------------------------
 
 bool Scanner::tokenize( std::string & error_message ) {
 
   unsigned line_number = 0;
+  unsigned last_line = 0;
   
   for( auto & line : filetext ) {
 
@@ -125,8 +175,9 @@ bool Scanner::tokenize( std::string & error_message ) {
       consume_whitespace( line, pos );
       if( pos >= line.length() ) { break; }
 
+      last_line = line_number;
+
       if( is_meta_statement( line, pos ) ) {
-	tokens.emplace_back( TokenType::META_STATEMENT, line.substr(pos), line_number );
 	break;
       }
 
@@ -136,7 +187,7 @@ bool Scanner::tokenize( std::string & error_message ) {
 	
 	if( legal_string ) {
 	  
-	  tokens.emplace_back( TokenType::STRING, line.substr(pos, (stop-pos+1)), line_number );
+	  add_token( TokenType::STRING, line, pos, (stop-pos+1), line_number );
 	  pos = stop+1;
 	  continue;
 	  
@@ -152,24 +203,23 @@ bool Scanner::tokenize( std::string & error_message ) {
       }
 
       if( is_reserved_word_or_identifier( line, pos, stop ) ) {
-	std::string word = line.substr(pos,(stop-pos+1));
-	if( is_reserved_word( word ) ) {
-	  tokens.emplace_back( TokenType::RESERVED_WORD, word, line_number );
+	if( is_reserved_word( line, pos, (stop-pos+1) ) ) {
+	  add_token( TokenType::RESERVED_WORD, line, pos, (stop-pos+1), line_number );
 	} else {
-	  tokens.emplace_back( TokenType::IDENTIFIER, word, line_number );
+	  add_token( TokenType::IDENTIFIER, line, pos, (stop-pos+1), line_number );
 	}
 	pos = stop+1;
 	continue;
       }
       
       if( is_symbol( line, pos, stop ) ) {
-	tokens.emplace_back( TokenType::SYMBOL, line.substr( pos, (stop-pos+1) ), line_number );
+	add_token( TokenType::SYMBOL, line, pos, (stop-pos+1), line_number );
 	pos = stop+1;
 	continue;
       }
       
       if( is_number( line, pos, stop ) ) {
-	tokens.emplace_back( TokenType::NUMBER, line.substr( pos, (stop-pos+1) ), line_number );
+	add_token( TokenType::NUMBER, line, pos, (stop-pos+1), line_number );
 	pos = stop+1;
 	continue;
       }
@@ -185,7 +235,7 @@ bool Scanner::tokenize( std::string & error_message ) {
     
   }
 
-  tokens.emplace_back( TokenType::EOF_TOK, "", 0 );
+  add_token( TokenType::EOF_TOK, std::string{}, 0, 0, last_line );
   
   return(true);
 }
@@ -313,9 +363,16 @@ bool Scanner::is_reserved_word_or_identifier( const std::string & text, unsigned
   
 }
 
-bool Scanner::is_reserved_word( const std::string & text ) {
+bool Scanner::is_reserved_word( const std::string & text, unsigned start, unsigned length ) {
+
+  // No reserved word is longer than 8 characters, and a word that short is
+  // copied into the string itself, not onto the heap, to look it up.
+
+  if( length > 8 ) {
+    return(false);
+  }
 
-  auto rw = reserved_words.find( text );
+  auto rw = reserved_words.find( text.substr( start, length ) );
   if( rw != reserved_words.end() ) {
     return(true);
   }
@@ -0,0 +1,110 @@
+#include "table_parser.h"
+
+#include "grammar.h"
+#include "parser.h"
+#include "scanner.h"
+#include "token.h"
+#include "token_source.h"
+
+#include <cstdint>
+#include <string>
+
+template< typename Source >
+TableParser<Source>::TableParser( const Grammar & grammar ) :
+  grammar(grammar), cursor{}, stack{}, errors{}, expansions{0}
+{
+}
+
+template< typename Source >
+TableParser<Source>::~TableParser() {
+}
+
+//-----------------------------------------------------------------------------
+// 'terminal' is what the token under the cursor matches, no_symbol for a
+// token the grammar has no terminal for and for the end, once the end of
+// file token has been matched.
+//-----------------------------------------------------------------------------
+
+template< typename Source >
+bool TableParser<Source>::parse( const Source & source ) {
+
+  stack.clear();
+  errors.clear();
+  expansions = 0;
+
+  cursor.start( source );
+
+  if( !cursor.seek( 0 ) ) {
+    return(false);
+  }
+
+  std::uint32_t terminal = grammar.terminal_of( cursor.current() );
+
+  stack.push_back( grammar.get_start() );
+
+  while( !stack.empty() ) {
+
+    std::uint32_t symbol = stack.back();
+    stack.pop_back();
+
+    if( grammar.is_terminal( symbol ) ) {
+
+      if( symbol != terminal ) {
+	return( fail( source, cursor.position() ) );
+      }
+
+      terminal = cursor.advance() ? grammar.terminal_of( cursor.current() ) : Grammar::no_symbol;
+
+    } else {
+
+      std::uint32_t production = grammar.predict( symbol, terminal );
+
+      if( production == Grammar::no_production ) {
+	return( fail( source, cursor.position() ) );
+      }
+
+      ++expansions;
+
+      for( const std::uint32_t *next = grammar.end_of( production ); next != grammar.begin_of( production ); ) {
+	stack.push_back( *--next );
+      }
+
+    }
+
+  }
+
+  if( (terminal != Grammar::no_symbol) && (cursor.current().get_token_type() != TokenType::EOF_TOK) ) {
+    return( fail( source, cursor.position() ) );
+  }
+
+  return(true);
+
+}
+
+template< typename Source >
+bool TableParser<Source>::fail( const Source & source, std::uint32_t token ) {
+
+  const Token & word = source.get_token( token );
+
+  if( word.get_token_type() == TokenType::EOF_TOK ) {
+
+    errors.push_back( ParseError{ token, word.get_line_number(),
+	  "Unexpected end of file after line " + std::to_string( word.get_line_number() ) + "." } );
+
+  } else {
+
+    errors.push_back( ParseError{ token, word.get_line_number(),
+	  "Unexpected '" + word.get_token_name() + "' on line " + std::to_string( word.get_line_number() ) + "." } );
+
+  }
+
+  return(false);
+
+}
+
+//-----------------------------------------------------------------------------
+// The token sources the parser is built for.  A new source is added here.
+//-----------------------------------------------------------------------------
+
+template class TableParser<Scanner>;
+template class TableParser<TokenTable>;
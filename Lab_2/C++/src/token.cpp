@@ -1,5 +1,9 @@
 #include "token.h"
 
+#include <cstddef>
+#include <string>
+#include <utility>
+
 //-----------------------------------------------------------------------------
 // This class is simple and self-explanatory.  For the initial assignment the
 // symbol value is recorded as the string character.  For the parser assignment
@@ -45,10 +49,10 @@ Token::Token( const Token & token ) {
   
 }
 
-Token::Token( Token && token ) :
+Token::Token( Token && token ) noexcept :
   token_type{token.token_type},
   name{ std::move( token.name ) },
-  line_number{line_number} {
+  line_number{token.line_number} {
 }
 
 const Token & Token::operator=( const Token & source ) {
@@ -63,7 +67,7 @@ const Token & Token::operator=( const Token & source ) {
   
 }
 
-const Token & Token::operator=( Token && source ) {
+const Token & Token::operator=( Token && source ) noexcept {
 
   if( this != &source ) {
     this->token_type = source.token_type;
@@ -75,19 +79,27 @@ const Token & Token::operator=( Token && source ) {
   
 }
 
-TokenType Token::get_token_type( void ) {
+void Token::assign( TokenType type, const std::string & text, std::size_t start, std::size_t length, unsigned line_number ) {
+
+  this->token_type = type;
+  this->name.assign( text, start, length );
+  this->line_number = line_number;
+
+}
+
+TokenType Token::get_token_type( void ) const {
 
   return( token_type );
   
 }
 
-const std::string & Token::get_token_name( void ) {
+const std::string & Token::get_token_name( void ) const {
 
   return( name );
   
 }
 
-unsigned Token::get_line_number( void ) {
+unsigned Token::get_line_number( void ) const {
 
   return(line_number);
   
@@ -0,0 +1,229 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// An event is a span when it has a duration, an instant otherwise.  Times are
+// in nanoseconds since trace_start().
+//-----------------------------------------------------------------------------
+
+static const std::size_t detail_size = 32;
+
+struct TraceEvent {
+  const char    *name;
+  char          detail[detail_size];
+  unsigned      line;
+  std::int64_t  start;
+  std::int64_t  duration;
+};
+
+struct TraceBuffer {
+  unsigned                thread;
+  std::vector<TraceEvent> events;
+  std::uint64_t           recorded;
+};
+
+//-----------------------------------------------------------------------------
+// The lock is taken only when a thread records its first event, to add its
+// buffer to the list, and by trace_write().
+//-----------------------------------------------------------------------------
+
+static std::atomic<bool> enabled{false};
+static std::size_t buffer_capacity = 0;
+static std::chrono::steady_clock::time_point epoch;
+static std::mutex buffers_lock;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+static thread_local TraceBuffer *local_buffer = nullptr;
+
+void trace_start( std::size_t capacity ) {
+
+  std::lock_guard<std::mutex> lock( buffers_lock );
+
+  buffer_capacity = std::max<std::size_t>( capacity, 1 );
+  epoch = std::chrono::steady_clock::now();
+  enabled.store( true, std::memory_order_release );
+
+}
+
+bool trace_enabled( void ) {
+
+  return( enabled.load( std::memory_order_relaxed ) );
+
+}
+
+static std::int64_t trace_now( void ) {
+
+  return( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - epoch ).count() );
+
+}
+
+static void record( const char *name, const std::string *detail, unsigned line, std::int64_t start, std::int64_t duration ) {
+
+  if( local_buffer == nullptr ) {
+    std::lock_guard<std::mutex> lock( buffers_lock );
+    buffers.emplace_back( new TraceBuffer{ static_cast<unsigned>( buffers.size() + 1 ), {}, 0 } );
+    buffers.back()->events.resize( buffer_capacity );
+    local_buffer = buffers.back().get();
+  }
+
+  TraceEvent & event = local_buffer->events[local_buffer->recorded++ % local_buffer->events.size()];
+
+  event.name = name;
+  event.line = line;
+  event.start = start;
+  event.duration = duration;
+  event.detail[0] = '\0';
+
+  if( detail != nullptr ) {
+    std::size_t length = detail->copy( event.detail, detail_size - 1 );
+    event.detail[length] = '\0';
+  }
+
+}
+
+void trace_instant( const char *name, const std::string & detail ) {
+
+  if( trace_enabled() ) {
+    record( name, &detail, 0, trace_now(), -1 );
+  }
+
+}
+
+TraceSpan::TraceSpan( const char *name ) :
+  name(name), detail{nullptr}, line{0}, start{trace_enabled() ? trace_now() : -1}
+{
+}
+
+TraceSpan::TraceSpan( const char *name, const std::string & detail, unsigned line ) :
+  name(name), detail{&detail}, line{line}, start{trace_enabled() ? trace_now() : -1}
+{
+}
+
+TraceSpan::~TraceSpan() {
+
+  if( start >= 0 ) {
+    record( name, detail, line, start, trace_now() - start );
+  }
+
+}
+
+//-----------------------------------------------------------------------------
+// The JSON object format of the trace event format, times in microseconds.
+// Threads are numbered in the order they first recorded, the first being the
+// one that started the trace in the usual case.  Events lost to full buffers
+// are counted in otherData.
+//-----------------------------------------------------------------------------
+
+static void write_string( std::ostream & out, const char *text ) {
+
+  out << '"';
+
+  for( ; *text != '\0'; ++text ) {
+    if( (*text == '"') || (*text == '\\') ) {
+      out << '\\' << *text;
+    } else if( static_cast<unsigned char>( *text ) < 0x20 ) {
+      out << ' ';
+    } else {
+      out << *text;
+    }
+  }
+
+  out << '"';
+
+}
+
+static void write_time( std::ostream & out, std::int64_t nanoseconds ) {
+
+  char text[32];
+
+  std::snprintf( text, sizeof( text ), "%lld.%03lld", static_cast<long long>( nanoseconds / 1000 ),
+		 static_cast<long long>( nanoseconds % 1000 ) );
+
+  out << text;
+
+}
+
+bool trace_write( const std::string & filename, std::string & error_message ) {
+
+  std::ofstream out( filename, std::ios::out | std::ios::trunc );
+
+  if( !out.is_open() ) {
+    error_message = "Failed to open file '" + filename + "'.";
+    return(false);
+  }
+
+  std::lock_guard<std::mutex> lock( buffers_lock );
+  std::uint64_t dropped = 0;
+  const char *separator = "\n";
+
+  out << "{ \"traceEvents\": [";
+
+  for( const std::unique_ptr<TraceBuffer> & buffer : buffers ) {
+
+    std::uint64_t capacity = buffer->events.size();
+    std::uint64_t first = (buffer->recorded > capacity) ? buffer->recorded - capacity : 0;
+
+    dropped += first;
+
+    std::string thread_name = (buffer->thread == 1) ? "main" : "thread " + std::to_string( buffer->thread );
+
+    out << separator << "  { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread
+	<< ", \"args\": { \"name\": \"" << thread_name << "\" } }";
+    separator = ",\n";
+
+    for( std::uint64_t index = first; index < buffer->recorded; ++index ) {
+
+      const TraceEvent & event = buffer->events[index % capacity];
+      bool named = (event.detail[0] != '\0');
+
+      out << separator << "  { \"name\": ";
+      write_string( out, (named && (event.duration >= 0)) ? event.detail : event.name );
+      out << ", \"cat\": \"" << event.name << "\", \"ph\": \"" << ((event.duration >= 0) ? "X" : "i") << "\", \"ts\": ";
+      write_time( out, event.start );
+
+      if( event.duration >= 0 ) {
+	out << ", \"dur\": ";
+	write_time( out, event.duration );
+      } else {
+	out << ", \"s\": \"t\"";
+      }
+
+      out << ", \"pid\": 1, \"tid\": " << buffer->thread;
+
+      if( named ) {
+	out << ", \"args\": { \"" << ((event.duration >= 0) ? "line" : "detail") << "\": ";
+	if( event.duration >= 0 ) {
+	  out << event.line;
+	} else {
+	  write_string( out, event.detail );
+	}
+	out << " }";
+      }
+
+      out << " }";
+
+    }
+
+  }
+
+  out << "\n], \"displayTimeUnit\": \"ns\", \"otherData\": { \"dropped_events\": \"" << dropped << "\" } }\n";
+
+  if( !out ) {
+    error_message = "Failed to write file '" + filename + "'.";
+    return(false);
+  }
+
+  return(true);
+
+}